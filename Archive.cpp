@@ -0,0 +1,137 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+#include "lib.h"
+#include "parse.h"
+#include "batch.h"
+#include "archive.h"
+
+// Converts between text puzzles and binary archives (see `archive.h`)
+//
+//   Archive pack <archive> <file>...
+//   Archive pack-lines <archive> <puzzles> [solutions]
+//   Archive unpack <archive> [i]
+//   Archive unpack-lines <archive> [--solutions]
+
+static void PackLines(
+    std::string archive_file,
+    std::string puzzles_file,
+    std::string solutions_file
+) {
+    ArchiveWriter archive(archive_file);
+    MappedFile puzzles(puzzles_file);
+    std::unique_ptr<MappedFile> solutions;
+    if (!solutions_file.empty()) {
+        solutions.reset(new MappedFile(solutions_file));
+    }
+
+    Problem problem;
+    State solution;
+    std::vector<int> cells;
+    const char* p = puzzles.Begin();
+    const char* q = solutions ? solutions->Begin() : nullptr;
+    size_t line = 0;
+    while (p < puzzles.End()) {
+        const char* end = (const char*)memchr(p, '\n', puzzles.End() - p);
+        if (!end) end = puzzles.End();
+        line++;
+        if (end == p) {
+            p = end + 1;
+            continue;
+        }
+
+        size_t n;
+        if (ParseLine(p, end, n, cells) != ParseStatus::Ok) {
+            throw std::invalid_argument(
+                "Invalid puzzle on line " + std::to_string(line)
+            );
+        }
+        problem.Init(n, cells);
+        p = end + 1;
+
+        if (!solutions) {
+            archive.Write(problem);
+            continue;
+        }
+
+        // Solutions are in the same order, one per line
+        const char* q_end = q < solutions->End() ?
+            (const char*)memchr(q, '\n', solutions->End() - q) :
+            nullptr;
+        if (!q_end) q_end = solutions->End();
+        size_t solution_n;
+        if (
+            ParseLine(q, q_end, solution_n, cells) != ParseStatus::Ok ||
+            solution_n != n
+        ) {
+            throw std::invalid_argument(
+                "Invalid solution on line " + std::to_string(line)
+            );
+        }
+        q = q_end + 1;
+
+        solution = State(&problem);
+        for (size_t i = 0; i < cells.size(); ++i) {
+            if (!problem.IsFixed(i)) solution.Set(i, cells[i]);
+        }
+        archive.Write(problem, &solution);
+    }
+
+    std::cerr << archive.Size() << " boards" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        throw std::invalid_argument("Invalid number of arguments");
+    }
+    std::string command = argv[1];
+    std::string archive_file = argv[2];
+
+    if (command == "pack") {
+        ArchiveWriter archive(archive_file);
+        for (int i = 3; i < argc; ++i) {
+            Problem problem(argv[i]);
+            archive.Write(problem);
+        }
+        std::cerr << archive.Size() << " boards" << std::endl;
+    } else if (command == "pack-lines") {
+        if (argc != 4 && argc != 5) {
+            throw std::invalid_argument("Invalid number of arguments");
+        }
+        PackLines(archive_file, argv[3], argc == 5 ? argv[4] : "");
+    } else if (command == "unpack") {
+        ArchiveReader archive(archive_file);
+        Problem problem;
+        std::string out;
+        if (argc == 4) {
+            archive.Read(std::stoul(argv[3]), problem);
+            FormatRows(problem.fixed, problem.n, out);
+            std::cout << out;
+        } else {
+            while (archive.Next(problem)) {
+                FormatRows(problem.fixed, problem.n, out);
+                std::cout << out << "\n";
+            }
+        }
+    } else if (command == "unpack-lines") {
+        bool solutions = argc == 4 && std::string(argv[3]) == "--solutions";
+        ArchiveReader archive(archive_file);
+        Problem problem;
+        State solution;
+        std::string out;
+        while (archive.Next(problem, &solution)) {
+            FormatBoard(
+                solutions ? solution.data : problem.fixed, problem.n, out
+            );
+            out += '\n';
+            std::cout.write(out.data(), out.size());
+        }
+    } else {
+        throw std::invalid_argument("Unknown command `" + command + "`");
+    }
+
+    return 0;
+}
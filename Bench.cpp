@@ -0,0 +1,233 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "lib.h"
+#include "exact.h"
+#include "generate.h"
+#include "rate.h"
+#include "multi.h"
+#include "alloc.h"
+
+// Microbenchmarks and full solves over the `tests/` puzzles and a generated
+// corpus. One row per benchmark, as CSV (default) or JSON:
+//
+//   Bench [--format=csv|json] [--min-time=<seconds>] [--filter=<text>]
+//       [--out=<file>]
+
+struct Result {
+    std::string name;
+    std::string puzzle;
+    size_t ops = 0;
+    double seconds = 0;
+    size_t allocs = 0;
+    size_t bytes = 0;
+
+    double NsPerOp() const { return ops ? seconds * 1e9 / ops : 0; }
+    double OpsPerSecond() const { return seconds > 0 ? ops / seconds : 0; }
+};
+
+static double min_time = 0.2;
+static std::string filter;
+static std::vector<Result> results;
+
+// Keeps results alive so the compiler can't drop the work
+static volatile size_t sink;
+
+// Calls `f` in doubling rounds until `min_time` has passed. `f` does one
+// operation per call.
+template<class F>
+static void Run(std::string name, std::string puzzle, F f) {
+    std::string label = name + " " + puzzle;
+    if (label.find(filter) == std::string::npos) return;
+    f();
+
+    Result result;
+    result.name = name;
+    result.puzzle = puzzle;
+    size_t allocs = AllocationCount();
+    size_t bytes = AllocatedBytes();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t round = 1; result.seconds < min_time; round *= 2) {
+        for (size_t i = 0; i < round; ++i) f();
+        result.ops += round;
+        result.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+    }
+    result.allocs = AllocationCount() - allocs;
+    result.bytes = AllocatedBytes() - bytes;
+    results.push_back(result);
+    std::cerr << label << ": " << result.NsPerOp() << " ns/op" << std::endl;
+}
+
+static void Micro(std::string filename) {
+    Problem problem("tests/" + filename);
+    State a = problem.RandomState();
+    State b = problem.RandomState();
+    // Reused like the solvers do, so only the hot paths are measured
+    State out = a;
+
+    Run("CountConflicts", filename, [&] () {
+        a.eval = tl::nullopt;
+        sink = sink + a.CountConflicts();
+    });
+    Run("Successor", filename, [&] () {
+        // One full neighbourhood per op
+        StateIter iter(&a);
+        while (iter.Successor(out)) sink = sink + out.hash;
+    });
+    Run("Mutate", filename, [&] () {
+        problem.Mutate(out);
+        sink = sink + out.hash;
+    });
+    Run("OnePointCrossover", filename, [&] () {
+        problem.OnePointCrossover(a, b, out);
+        sink = sink + out.hash;
+    });
+    Run("NPointCrossover", filename, [&] () {
+        problem.NPointCrossover(a, b, out);
+        sink = sink + out.hash;
+    });
+    Run("UniformCrossover", filename, [&] () {
+        problem.UniformCrossover(a, b, out);
+        sink = sink + out.hash;
+    });
+    Run("Randomize", filename, [&] () {
+        problem.Randomize(out);
+        sink = sink + out.hash;
+    });
+}
+
+// Runs `solve` over every puzzle of a corpus per op
+template<class F>
+static void Corpus(
+    std::string name,
+    std::string corpus,
+    std::vector<Problem>& problems,
+    F solve
+) {
+    Run(name, corpus, [&] () {
+        for (auto& problem : problems) solve(problem);
+    });
+}
+
+int main(int argc, char *argv[]) {
+    std::string format = "csv";
+    std::string out_file;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 9, "--format=") == 0) {
+            format = arg.substr(9);
+        } else if (arg.compare(0, 11, "--min-time=") == 0) {
+            min_time = std::stod(arg.substr(11));
+        } else if (arg.compare(0, 9, "--filter=") == 0) {
+            filter = arg.substr(9);
+        } else if (arg.compare(0, 6, "--out=") == 0) {
+            out_file = arg.substr(6);
+        } else {
+            throw std::invalid_argument("Unknown option `" + arg + "`");
+        }
+    }
+
+    std::string filenames[] = { "sample4", "sample9", "sample16" };
+    for (auto filename : filenames) Micro(filename);
+
+    // Full solves of single puzzles
+    Problem sample4("tests/sample4");
+    Problem sample9("tests/sample9");
+    Run("HillClimber", "sample4", [&] () {
+        sink = sink + sample4.HillClimber(Checkpoint()).best.hash;
+    });
+    Run("Genetic", "sample4", [&] () {
+        Checkpoint checkpoint = sample4.Genetic(
+            Checkpoint(), 200, 0.1, 200, 0,
+            Problem::CrossoverType::Uniform, 1
+        );
+        sink = sink + checkpoint.best.hash;
+    });
+    Run("SolveExact", "sample9", [&] () {
+        sink = sink + SolveExact(sample9).best.hash;
+    });
+
+    // Generated corpora, the same every run
+    struct CorpusSpec {
+        std::string name;
+        size_t givens;
+    };
+    CorpusSpec specs[] = { { "gen9_40", 40 }, { "gen9_25", 25 } };
+    for (auto& spec : specs) {
+        GeneratorOptions options;
+        options.givens = spec.givens;
+        Generator generator(1);
+        std::vector<Problem> problems(multi_lanes * 8);
+        std::vector<int> puzzle;
+        for (auto& problem : problems) {
+            generator.Generate(options, puzzle);
+            problem.Load(9, puzzle.data());
+        }
+
+        Corpus("SolveExact", spec.name, problems, [] (Problem& problem) {
+            sink = sink + SolveExact(problem).is_goal;
+        });
+        Corpus("Rate", spec.name, problems, [] (Problem& problem) {
+            static Rater rater;
+            static Rating rating;
+            rater.Rate(problem, rating);
+            sink = sink + rating.solved;
+        });
+        MultiSolver solver;
+        std::vector<int> solutions[multi_lanes];
+        std::vector<bool> solved(multi_lanes);
+        Run("MultiSolver", spec.name, [&] () {
+            for (size_t i = 0; i < problems.size(); i += multi_lanes) {
+                sink = sink + solver.Solve(
+                    &problems[i], multi_lanes, solutions, solved
+                );
+            }
+        });
+        Run("Generate", spec.name, [&] () {
+            generator.Generate(options, puzzle);
+            sink = sink + puzzle[0];
+        });
+    }
+
+    std::ostringstream out;
+    if (format == "json") {
+        out << "[\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            out <<
+                "  {\"name\": \"" << r.name << "\", \"puzzle\": \"" <<
+                r.puzzle << "\", \"ops\": " << r.ops << ", \"ns_per_op\": " <<
+                r.NsPerOp() << ", \"ops_per_s\": " << r.OpsPerSecond() <<
+                ", \"allocs_per_op\": " << (double)r.allocs / r.ops <<
+                ", \"bytes_per_op\": " << (double)r.bytes / r.ops << "}" <<
+                (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "]\n";
+    } else if (format == "csv") {
+        out <<
+            "name,puzzle,ops,ns_per_op,ops_per_s,allocs_per_op," <<
+            "bytes_per_op\n";
+        for (const Result& r : results) {
+            out <<
+                r.name << "," << r.puzzle << "," << r.ops << "," <<
+                r.NsPerOp() << "," << r.OpsPerSecond() << "," <<
+                (double)r.allocs / r.ops << "," <<
+                (double)r.bytes / r.ops << "\n";
+        }
+    } else {
+        throw std::invalid_argument("Unknown format `" + format + "`");
+    }
+
+    if (out_file.empty()) {
+        std::cout << out.str();
+    } else {
+        std::ofstream(out_file) << out.str();
+    }
+
+    return 0;
+}
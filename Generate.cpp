@@ -0,0 +1,94 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include "lib.h"
+#include "parse.h"
+#include "generate.h"
+
+// Writes puzzles with a unique solution (see `generate.h`)
+//
+//   Generate <count> [givens] [--n=<n>] [--seed=<s>] [--rows]
+//       [--min-branches=<b>] [--max-branches=<b>] [--solutions=<file>]
+//
+// Puzzles go to stdout one per line, the batch format, or with `--rows` in
+// the format of `tests/` separated by blank lines.
+
+int main(int argc, char *argv[]) {
+    GeneratorOptions options;
+    uint64_t seed = std::random_device()();
+    bool rows = false;
+    std::string solutions_file;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 4, "--n=") == 0) {
+            options.n = std::stoul(arg.substr(4));
+        } else if (arg.compare(0, 7, "--seed=") == 0) {
+            seed = std::stoull(arg.substr(7));
+        } else if (arg == "--rows") {
+            rows = true;
+        } else if (arg.compare(0, 15, "--min-branches=") == 0) {
+            options.min_branches = std::stoul(arg.substr(15));
+        } else if (arg.compare(0, 15, "--max-branches=") == 0) {
+            options.max_branches = std::stoul(arg.substr(15));
+        } else if (arg.compare(0, 12, "--solutions=") == 0) {
+            solutions_file = arg.substr(12);
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    if (args.size() != 2 && args.size() != 3) {
+        throw std::invalid_argument("Invalid number of arguments");
+    }
+    size_t count = std::stoul(args[1]);
+    if (args.size() == 3) options.givens = std::stoul(args[2]);
+
+    std::vector<int> board(options.n * options.n);
+    if (Problem().Load(options.n, board.data()) != ParseStatus::Ok) {
+        throw std::invalid_argument("Board size must be a square");
+    }
+
+    std::ofstream solutions;
+    if (!solutions_file.empty()) solutions.open(solutions_file);
+
+    auto start = std::chrono::steady_clock::now();
+    Generator generator(seed);
+    std::vector<int> puzzle;
+    std::vector<int> solution;
+    std::string out;
+    size_t generated = 0;
+    for (; generated < count; ++generated) {
+        if (!generator.Generate(options, puzzle, &solution)) {
+            std::cerr << "Couldn't generate a puzzle with " <<
+                options.givens << " givens in the difficulty band" <<
+                std::endl;
+            break;
+        }
+        if (rows) {
+            FormatRows(puzzle, options.n, out);
+            if (generated > 0) std::cout << "\n";
+        } else {
+            FormatBoard(puzzle, options.n, out);
+            out += '\n';
+        }
+        std::cout << out;
+        if (solutions.is_open()) {
+            FormatBoard(solution, options.n, out);
+            solutions << out << "\n";
+        }
+    }
+    std::cout.flush();
+
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+    std::cerr <<
+        generated << " puzzles in " << seconds << "s (" <<
+        (seconds > 0 ? generated / seconds : 0) << " puzzles/s)" << std::endl;
+
+    return generated == count ? 0 : 1;
+}
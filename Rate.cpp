@@ -0,0 +1,86 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "lib.h"
+#include "parse.h"
+#include "batch.h"
+#include "rate.h"
+
+// Grades puzzles by the human techniques they need (see `rate.h`)
+//
+//   Rate <file>
+//   Rate --batch <file> [--workers=<k>] [--out=<file>]
+//
+// In batch mode each output line is the puzzle followed by its rating.
+
+int main(int argc, char *argv[]) {
+    bool batch = false;
+    std::string out_file;
+    size_t n_workers = 1;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--batch") {
+            batch = true;
+        } else if (arg.compare(0, 6, "--out=") == 0) {
+            out_file = arg.substr(6);
+        } else if (arg.compare(0, 10, "--workers=") == 0) {
+            n_workers = std::max(std::stoul(arg.substr(10)), 1ul);
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    if (args.size() != 2) {
+        throw std::invalid_argument("Invalid number of arguments");
+    }
+    std::string filename = args[1];
+
+    if (batch) {
+        MappedFile in(filename);
+        std::ofstream out_f;
+        if (!out_file.empty()) out_f.open(out_file);
+        std::ostream& out = out_file.empty() ? std::cout : out_f;
+
+        auto rate = [] (Problem& problem, std::string& line) {
+            thread_local Rater rater;
+            thread_local Rating rating;
+            rater.Rate(problem, rating);
+            FormatBoard(problem.fixed, problem.n, line);
+            line += ' ';
+            FormatRating(rating, line);
+            return rating.solved;
+        };
+        BatchStats stats = ProcessBatch(
+            in.Begin(), in.End(), out, rate, n_workers
+        );
+        std::cerr <<
+            stats.solved << " / " << stats.puzzles <<
+            " solved without guessing in " << stats.seconds << "s (" <<
+            stats.PuzzlesPerSecond() << " puzzles/s)" << std::endl;
+        return 0;
+    }
+
+    Problem problem(filename);
+    problem.Print();
+    std::cout << std::endl;
+
+    Rater rater;
+    Rating rating;
+    rater.Rate(problem, rating);
+    for (size_t t = 0; t < n_techniques; ++t) {
+        if (rating.steps[t] == 0) continue;
+        std::cout <<
+            TechniqueName((Technique)t) << ": " << rating.steps[t] <<
+            std::endl;
+    }
+    if (!rating.solved) {
+        std::cout << "Needs guessing from here:" << std::endl;
+        PrintBoard(rating.board, problem.n);
+    }
+    std::cout << "Grade: " << rating.grade << std::endl;
+
+    return 0;
+}
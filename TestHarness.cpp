@@ -1,14 +1,85 @@
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <tuple>
+#include <vector>
+#include <algorithm>
+#include <functional>
 #include "lib.h"
+#include "batch.h"
+#include "exact.h"
+#include "multi.h"
+#include "portfolio.h"
+#include "trace.h"
 #include "optional.hpp"
 
 int main(int argc, char *argv[]) {
+    // Options may appear anywhere; strip them before the positional
+    // arguments are read
+    size_t interval = 1;
+    int verbosity = 2;
+    std::string resume_file;
+    std::string save_file;
+    size_t max_iters = 0;
+    bool batch = false;
+    std::string out_file;
+    size_t n_workers = 1;
+    double time_limit = 0;
+    size_t max_evals = 0;
+    std::string trace_file;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quiet") {
+            verbosity = 0;
+        } else if (arg.compare(0, 11, "--interval=") == 0) {
+            interval = std::max(std::stoul(arg.substr(11)), 1ul);
+        } else if (arg.compare(0, 12, "--verbosity=") == 0) {
+            verbosity = std::stoi(arg.substr(12));
+        } else if (arg.compare(0, 9, "--resume=") == 0) {
+            resume_file = arg.substr(9);
+        } else if (arg.compare(0, 7, "--save=") == 0) {
+            save_file = arg.substr(7);
+        } else if (arg.compare(0, 12, "--max-iters=") == 0) {
+            max_iters = std::stoul(arg.substr(12));
+        } else if (arg == "--batch") {
+            batch = true;
+        } else if (arg.compare(0, 6, "--out=") == 0) {
+            out_file = arg.substr(6);
+        } else if (arg.compare(0, 10, "--workers=") == 0) {
+            n_workers = std::max(std::stoul(arg.substr(10)), 1ul);
+        } else if (arg.compare(0, 13, "--time-limit=") == 0) {
+            time_limit = std::stod(arg.substr(13));
+        } else if (arg.compare(0, 12, "--max-evals=") == 0) {
+            max_evals = std::stoul(arg.substr(12));
+        } else if (arg.compare(0, 8, "--trace=") == 0) {
+            trace_file = arg.substr(8);
+        } else if (arg == "--perf") {
+            EnablePerfCounters();
+            if (!PerfCountersAvailable()) {
+                std::cerr <<
+                    "Hardware counters unavailable, timing only" << std::endl;
+            }
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    argc = args.size();
+    argv = args.data();
+
+    Checkpoint checkpoint;
+    std::function<Checkpoint(Problem&)> solve;
+
 #ifdef GENETIC
-    if (argc != 8) {
+    if (argc != 8 && argc != 9) {
         throw std::invalid_argument("Invalid number of arguments");
     }
+    if (max_iters > 0) {
+        throw std::invalid_argument("--max-iters is for the hill climber");
+    }
+    if (batch && !trace_file.empty()) {
+        throw std::invalid_argument("--trace isn't supported in batch mode");
+    }
 
     size_t population_size = std::stoul(argv[2]);
     double mutate_prob = std::stod(argv[3]);
@@ -16,31 +87,175 @@ int main(int argc, char *argv[]) {
     size_t terminate_epsilon = std::stoul(argv[5]);
     auto type = (Problem::CrossoverType)std::stoi(argv[6]);
     size_t n_threads = std::stoul(argv[7]);
+    bool hash_index = argc == 9 && std::stoi(argv[8]) != 0;
+
+    solve = [&](Problem& problem) {
+        problem.genetic_options.hash_index = hash_index;
+        return problem.Genetic(
+            checkpoint,
+            population_size,
+            mutate_prob,
+            terminate_streak,
+            terminate_epsilon,
+            type,
+            n_threads
+        );
+    };
+#elif defined(PORTFOLIO)
+    if (argc != 2 && argc != 3) {
+        throw std::invalid_argument("Invalid number of arguments");
+    }
+    if (max_iters > 0 || !resume_file.empty()) {
+        throw std::invalid_argument(
+            "--max-iters and --resume are for the local search solvers"
+        );
+    }
+
+    // Shared by the batch workers, so wins add up over the batch
+    PortfolioOptions options;
+    options.n_threads = argc == 3 ? std::stoul(argv[2]) : 3;
+    Portfolio portfolio(options);
+
+    solve = [&](Problem& problem) {
+        return portfolio.Solve(problem);
+    };
+#elif defined(EXACT)
+    if (argc != 2 && argc != 3) {
+        throw std::invalid_argument("Invalid number of arguments");
+    }
+    if (max_iters > 0 || !resume_file.empty()) {
+        throw std::invalid_argument(
+            "--max-iters and --resume are for the local search solvers"
+        );
+    }
+
+    size_t n_threads = argc == 3 ? std::stoul(argv[2]) : 1;
+
+    solve = [&](Problem& problem) {
+        return SolveExact(problem, n_threads);
+    };
 #else
-    if (argc != 2) {
+    if (argc != 2 && argc != 3) {
         throw std::invalid_argument("Invalid number of arguments");
     }
+
+    size_t visited_capacity = argc == 3 ? std::stoul(argv[2]) : 0;
+
+    solve = [&](Problem& problem) {
+        problem.hill_options.visited_capacity = visited_capacity;
+        return problem.HillClimber(checkpoint, max_iters);
+    };
 #endif
 
+#ifndef GENETIC
+    if (!trace_file.empty()) {
+        throw std::invalid_argument("--trace is for the genetic algorithm");
+    }
+#endif
+
+    // Limits apply per puzzle, also in batch mode
+    if (time_limit > 0 || max_evals > 0) {
+        auto unlimited = solve;
+        solve = [=] (Problem& problem) {
+            if (time_limit > 0) problem.budget = Budget::Within(time_limit);
+            problem.budget.max_evals = max_evals;
+            return unlimited(problem);
+        };
+    }
+
     std::string filename = argv[1];
+
+    if (batch) {
+        if (!resume_file.empty() || !save_file.empty()) {
+            throw std::invalid_argument(
+                "Checkpoints aren't supported in batch mode"
+            );
+        }
+
+        // One puzzle per line in, one solution per line out
+        MappedFile in(filename);
+        std::ofstream out_f;
+        if (!out_file.empty()) out_f.open(out_file);
+        std::ostream& out = out_file.empty() ? std::cout : out_f;
+
+#ifdef EXACT
+        // Groups of 9x9 puzzles are propagated together (see `multi.h`)
+        auto solve_group = [] (BatchGroup& group) {
+            thread_local MultiSolver solver;
+            thread_local std::vector<int> solutions[multi_lanes];
+            solver.Solve(
+                group.problems.data(), group.size, solutions, group.solved
+            );
+            for (size_t k = 0; k < group.size; ++k) {
+                Problem& problem = group.problems[k];
+                FormatBoard(
+                    group.solved[k] ? solutions[k] : problem.fixed,
+                    problem.n,
+                    group.lines[k]
+                );
+            }
+        };
+        BatchStats stats = ProcessBatchGroups(
+            in.Begin(), in.End(), out, solve_group, multi_lanes, n_workers
+        );
+#else
+        BatchStats stats = SolveBatch(
+            in.Begin(), in.End(), out, solve, n_workers
+        );
+#endif
+        std::cerr <<
+            stats.solved << " / " << stats.puzzles << " solved in " <<
+            stats.seconds << "s (" << stats.PuzzlesPerSecond() <<
+            " puzzles/s)" << std::endl;
+        for (auto& stage : stats.stages) {
+            std::cerr <<
+                stage.name << ": " << stage.threads << " threads, " <<
+                stage.stall_seconds << "s stalled, queue depth " <<
+                stage.queue_depth_mean << " mean / " <<
+                stage.queue_depth_max << " max" << std::endl;
+        }
+#ifdef PORTFOLIO
+        for (size_t e = 0; e < n_portfolio_engines; ++e) {
+            std::cerr <<
+                PortfolioEngineName((PortfolioEngine)e) << " won " <<
+                portfolio.Wins((PortfolioEngine)e) << " / " <<
+                portfolio.Runs() << std::endl;
+        }
+#endif
+        return 0;
+    }
+
     Problem problem(filename);
     problem.Print();
     std::cout << std::endl;
 
-#ifdef GENETIC
-    bool is_goal;
-    State best_state;
-    std::tie(is_goal, best_state) = problem.Genetic(
-        population_size,
-        mutate_prob,
-        terminate_streak,
-        terminate_epsilon,
-        type,
-        n_threads
-    );
+    StreamProgress progress(std::cout, interval, verbosity);
+    problem.progress = &progress;
+
+    // Binary if the file name ends in `.bin`, CSV otherwise
+    std::ofstream trace_f;
+    std::unique_ptr<GeneticTrace> trace;
+    if (!trace_file.empty()) {
+        bool binary =
+            trace_file.size() >= 4 &&
+            trace_file.compare(trace_file.size() - 4, 4, ".bin") == 0;
+        trace_f.open(trace_file, std::ios::binary);
+        trace.reset(new GeneticTrace(
+            trace_f, binary ? TraceFormat::Binary : TraceFormat::Csv
+        ));
+        problem.trace = trace.get();
+    }
+
+    if (!resume_file.empty()) {
+        checkpoint = Checkpoint(&problem, resume_file);
+    }
+
+    checkpoint = solve(problem);
     std::cout << std::endl;
 
-    if (is_goal) {
+#ifdef GENETIC
+    State& best_state = checkpoint.best;
+    if (checkpoint.is_goal) {
         std::cout << "Found goal" << std::endl;
     } else {
         std::cout << "Couldn't find goal" << std::endl;
@@ -52,11 +267,56 @@ int main(int argc, char *argv[]) {
         problem.GoalEvalGenetic() << std::endl;
 
     best_state.Print();
+#elif defined(PORTFOLIO)
+    for (size_t e = 0; e < n_portfolio_engines; ++e) {
+        if (portfolio.Wins((PortfolioEngine)e) > 0) {
+            std::cout <<
+                "Won by " << PortfolioEngineName((PortfolioEngine)e) <<
+                std::endl;
+        }
+    }
+    if (!checkpoint.is_goal) {
+        std::cout << "Couldn't find goal" << std::endl;
+    }
+    checkpoint.best.Print();
+#elif defined(EXACT)
+    // Checking uniqueness is a second search, so it runs under the same
+    // budget, and only if the first one finished
+    if (checkpoint.stopped == BudgetStop::None) {
+        BudgetStop stopped;
+        size_t count = CountSolutionsWithin(problem, 2, n_threads, stopped);
+        if (stopped != BudgetStop::None) {
+            checkpoint.stopped = stopped;
+            std::cout << "Uniqueness unknown" << std::endl;
+        } else {
+            std::cout <<
+                (count == 0 ? "No solution" :
+                 count == 1 ? "Unique solution" : "Multiple solutions") <<
+                std::endl;
+        }
+    } else {
+        std::cout << "Couldn't find goal" << std::endl;
+    }
+    checkpoint.best.Print();
 #else
-    State ans = problem.HillClimber(problem.RandomState());
-    std::cout << std::endl;
-    ans.Print();
+    if (!checkpoint.is_goal) {
+        std::cout << "Couldn't find goal" << std::endl;
+    }
+    checkpoint.best.Print();
 #endif
 
+    if (checkpoint.stopped != BudgetStop::None) {
+        std::cout <<
+            "Stopped: " << BudgetStopName(checkpoint.stopped) << std::endl;
+    }
+
+    std::string stats;
+    FormatStats(checkpoint.stats, stats);
+    std::cerr << stats << std::endl;
+
+    if (!save_file.empty()) {
+        checkpoint.Save(save_file);
+    }
+
     return 0;
 }
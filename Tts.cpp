@@ -0,0 +1,97 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "lib.h"
+#include "tts.h"
+
+// Time-to-solution of every engine on every puzzle (see `tts.h`)
+//
+//   Tts <file>... [--runs=<k>] [--budget=<seconds>] [--seed=<s>]
+//       [--engines=<name>,<name>...] [--population=<size>]
+//       [--mutate-prob=<p>] [--streak=<k>] [--threads=<k>]
+//       [--out=<file>] [--runs-out=<file>]
+//
+// Writes one summary row per engine and puzzle as CSV, and with
+// `--runs-out` one row per run.
+
+int main(int argc, char *argv[]) {
+    TtsOptions options;
+    std::string engine_names;
+    std::string out_file;
+    std::string runs_file;
+    std::vector<std::string> filenames;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 7, "--runs=") == 0) {
+            options.runs = std::stoul(arg.substr(7));
+        } else if (arg.compare(0, 9, "--budget=") == 0) {
+            options.budget = std::stod(arg.substr(9));
+        } else if (arg.compare(0, 7, "--seed=") == 0) {
+            options.seed = std::stoul(arg.substr(7));
+        } else if (arg.compare(0, 10, "--engines=") == 0) {
+            engine_names = "," + arg.substr(10) + ",";
+        } else if (arg.compare(0, 13, "--population=") == 0) {
+            options.population = std::stoul(arg.substr(13));
+        } else if (arg.compare(0, 14, "--mutate-prob=") == 0) {
+            options.mutate_prob = std::stod(arg.substr(14));
+        } else if (arg.compare(0, 9, "--streak=") == 0) {
+            options.terminate_streak = std::stoul(arg.substr(9));
+        } else if (arg.compare(0, 10, "--threads=") == 0) {
+            options.n_threads = std::max(std::stoul(arg.substr(10)), 1ul);
+        } else if (arg.compare(0, 6, "--out=") == 0) {
+            out_file = arg.substr(6);
+        } else if (arg.compare(0, 11, "--runs-out=") == 0) {
+            runs_file = arg.substr(11);
+        } else if (arg.compare(0, 2, "--") == 0) {
+            throw std::invalid_argument("Unknown option `" + arg + "`");
+        } else {
+            filenames.push_back(arg);
+        }
+    }
+    if (filenames.empty()) {
+        throw std::invalid_argument("No puzzle files given");
+    }
+
+    std::vector<TtsEngine> engines;
+    for (auto& engine : DefaultEngines(options)) {
+        if (
+            engine_names.empty() ||
+            engine_names.find("," + engine.name + ",") != std::string::npos
+        ) {
+            engines.push_back(engine);
+        }
+    }
+    if (engines.empty()) {
+        throw std::invalid_argument("No engines match `" + engine_names + "`");
+    }
+
+    std::vector<TtsRun> runs;
+    for (auto& filename : filenames) {
+        Problem problem(filename);
+        for (auto& engine : engines) {
+            std::vector<TtsEngine> one(1, engine);
+            auto engine_runs = MeasureTts(one, problem, filename, options);
+            runs.insert(runs.end(), engine_runs.begin(), engine_runs.end());
+
+            TtsSummary summary = SummarizeTts(engine_runs)[0];
+            std::cerr <<
+                engine.name << " " << filename << ": " << summary.solved <<
+                " / " << summary.runs << " solved, median " <<
+                summary.median << "s" << std::endl;
+        }
+    }
+
+    std::ofstream out_f;
+    if (!out_file.empty()) out_f.open(out_file);
+    std::ostream& out = out_file.empty() ? std::cout : out_f;
+    WriteSummaryCsv(SummarizeTts(runs), out);
+
+    if (!runs_file.empty()) {
+        std::ofstream runs_out(runs_file);
+        WriteRunsCsv(runs, runs_out);
+    }
+
+    return 0;
+}
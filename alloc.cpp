@@ -0,0 +1,30 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "alloc.h"
+
+namespace {
+    std::atomic<size_t> n_allocs(0);
+    std::atomic<size_t> n_alloc_bytes(0);
+}
+
+// Array and nothrow forms go through this one by default
+void* operator new(size_t size) {
+    n_allocs.fetch_add(1, std::memory_order_relaxed);
+    n_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+size_t AllocationCount() {
+    return n_allocs.load();
+}
+
+size_t AllocatedBytes() {
+    return n_alloc_bytes.load();
+}
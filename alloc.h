@@ -0,0 +1,9 @@
+#pragma once
+#include <cstddef>
+
+// Heap allocations so far, over every thread. Only available in programs
+// linked with `alloc.cpp`, which replaces the global `operator new` (the
+// benchmarks and the allocation tests); the solvers themselves never link
+// it.
+size_t AllocationCount();
+size_t AllocatedBytes();
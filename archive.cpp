@@ -0,0 +1,224 @@
+#include <cstring>
+#include <stdexcept>
+#include "archive.h"
+
+static const char magic[4] = { 'S', 'D', 'K', 'B' };
+static const uint16_t version = 1;
+static const size_t header_size = 16;
+
+static void PutU64(uint8_t* p, uint64_t x) {
+    for (size_t i = 0; i < 8; ++i) p[i] = (x >> (8 * i)) & 0xff;
+}
+
+static uint64_t GetU64(const uint8_t* p) {
+    uint64_t x = 0;
+    for (size_t i = 0; i < 8; ++i) x |= (uint64_t)p[i] << (8 * i);
+    return x;
+}
+
+static size_t MaskBytes(size_t n) { return ((n * n) + 7) / 8; }
+
+static size_t CellBytes(size_t n) { return ((n * n * CellBits(n)) + 7) / 8; }
+
+// A square no bigger than the solvers handle, so a corrupt `n` isn't loaded
+static bool IsBoardSize(size_t n) {
+    size_t box = 1;
+    while (box * box < n) box++;
+    return n > 0 && n <= max_board_n && box * box == n;
+}
+
+size_t RecordSize(size_t n) {
+    return 1 + MaskBytes(n) + CellBytes(n);
+}
+
+ArchiveWriter::ArchiveWriter(std::string filename)
+    : f(filename, std::ios::binary), offset(header_size), closed(false) {
+    if (!f.good()) {
+        throw std::invalid_argument(
+            "Couldn't create file `" + filename + "`"
+        );
+    }
+    // The record count is patched in by `Close`
+    uint8_t header[header_size] = { 0 };
+    memcpy(header, magic, sizeof(magic));
+    header[4] = version & 0xff;
+    header[5] = version >> 8;
+    f.write((const char*)header, header_size);
+}
+
+ArchiveWriter::~ArchiveWriter() {
+    Close();
+}
+
+void ArchiveWriter::Write(Problem& problem, const State* solution) {
+    size_t n = problem.n;
+    size_t n_cells = n * n;
+    if (n == 0 || n > 31) {
+        throw std::invalid_argument("Board too big for an archive");
+    }
+
+    record.assign(RecordSize(n), 0);
+    record[0] = n;
+
+    uint8_t* mask = &record[1];
+    for (size_t i = 0; i < n_cells; ++i) {
+        if (problem.IsFixed(i)) mask[i / 8] |= 1 << (i % 8);
+    }
+
+    const std::vector<int>& values = solution ? solution->data : problem.fixed;
+    uint8_t* cells = mask + MaskBytes(n);
+    size_t bits = CellBits(n);
+    size_t bit = 0;
+    for (size_t i = 0; i < n_cells; ++i, bit += bits) {
+        // A cell spans at most two bytes
+        unsigned value = values[i] << (bit % 8);
+        cells[bit / 8] |= value & 0xff;
+        if (value >> 8) cells[(bit / 8) + 1] |= value >> 8;
+    }
+
+    f.write((const char*)record.data(), record.size());
+    offsets.push_back(offset);
+    offset += record.size();
+}
+
+void ArchiveWriter::Close() {
+    if (closed) return;
+    closed = true;
+
+    std::vector<uint8_t> index((offsets.size() + 1) * 8);
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        PutU64(&index[i * 8], offsets[i]);
+    }
+    PutU64(&index[offsets.size() * 8], offset);
+    f.write((const char*)index.data(), index.size());
+
+    uint8_t count[8];
+    PutU64(count, offsets.size());
+    f.seekp(8);
+    f.write((const char*)count, sizeof(count));
+    f.close();
+}
+
+ArchiveReader::ArchiveReader(std::string filename)
+    : file(filename), next(0) {
+    const uint8_t* begin = (const uint8_t*)file.Begin();
+    size_t size = file.Size();
+    if (size < header_size + 8 || memcmp(begin, magic, sizeof(magic)) != 0) {
+        throw std::invalid_argument("`" + filename + "` isn't an archive");
+    }
+    if ((begin[4] | (begin[5] << 8)) != version) {
+        throw std::invalid_argument(
+            "`" + filename + "` has an unsupported version"
+        );
+    }
+
+    // Compared without multiplying, so a corrupt count can't overflow
+    count = GetU64(begin + 8);
+    uint64_t index_offset = GetU64(begin + size - 8);
+    if (
+        count > (size - header_size - 8) / 8 ||
+        index_offset != size - (count * 8) - 8
+    ) {
+        throw std::invalid_argument("`" + filename + "` is truncated");
+    }
+    index = begin + index_offset;
+    cursor = begin + header_size;
+}
+
+// The record at `offset`, which must start between the header and the
+// index. `Decode` checks that the rest of it fits.
+const uint8_t* ArchiveReader::Record(uint64_t offset) {
+    const uint8_t* begin = (const uint8_t*)file.Begin();
+    if (offset < header_size || offset >= (uint64_t)(index - begin)) {
+        throw std::invalid_argument("Corrupt archive record");
+    }
+    return begin + offset;
+}
+
+void ArchiveReader::Decode(
+    const uint8_t* record,
+    Problem& problem,
+    State* solution
+) {
+    size_t n = record[0];
+    size_t n_cells = n * n;
+    if (!IsBoardSize(n) || RecordSize(n) > (size_t)(index - record)) {
+        throw std::invalid_argument("Corrupt archive record");
+    }
+
+    const uint8_t* mask = record + 1;
+    const uint8_t* packed = mask + MaskBytes(n);
+    size_t bits = CellBits(n);
+    unsigned value_mask = (1 << bits) - 1;
+
+    givens.resize(n_cells);
+    cells.resize(n_cells);
+    int* given = givens.data();
+    int* cell = cells.data();
+
+    if (bits == 4) {
+        // Two cells per byte
+        for (size_t i = 0; i + 1 < n_cells; i += 2) {
+            uint8_t byte = packed[i / 2];
+            cell[i] = byte & 0xf;
+            cell[i + 1] = byte >> 4;
+        }
+        if (n_cells % 2) {
+            cell[n_cells - 1] = packed[n_cells / 2] & 0xf;
+        }
+    } else {
+        size_t bit = 0;
+        for (size_t i = 0; i < n_cells; ++i, bit += bits) {
+            // May read one byte past the record, which is fine since the
+            // index always follows
+            unsigned word = packed[bit / 8] | (packed[(bit / 8) + 1] << 8);
+            cell[i] = (word >> (bit % 8)) & value_mask;
+        }
+    }
+
+    unsigned bad = 0;
+    for (size_t i = 0; i < n_cells; ++i) {
+        bad |= (unsigned)cell[i] > n;
+        // Branchless, the mask is too irregular to predict
+        given[i] = cell[i] & -(int)((mask[i / 8] >> (i % 8)) & 1);
+    }
+
+    if (bad) {
+        throw std::invalid_argument("Corrupt archive record");
+    }
+
+    problem.Init(n, givens);
+    if (solution) {
+        // Reuses the solution's buffer
+        solution->problem = &problem;
+        solution->data = cells;
+        solution->eval.reset();
+        solution->Rehash();
+    }
+}
+
+bool ArchiveReader::Next(Problem& problem, State* solution) {
+    if (next >= count) return false;
+    if (cursor >= index) {
+        throw std::invalid_argument("Corrupt archive record");
+    }
+    Decode(cursor, problem, solution);
+    cursor += RecordSize(cursor[0]);
+    next++;
+    return true;
+}
+
+void ArchiveReader::Seek(size_t i) {
+    if (i > count) {
+        throw std::out_of_range("Archive record out of range");
+    }
+    next = i;
+    if (i < count) cursor = Record(GetU64(index + (i * 8)));
+}
+
+void ArchiveReader::Read(size_t i, Problem& problem, State* solution) {
+    if (i >= count) {
+        throw std::out_of_range("Archive record out of range");
+    }
+    Decode(Record(GetU64(index + (i * 8))), problem, solution);
+}
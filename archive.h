@@ -0,0 +1,74 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <memory>
+#include "lib.h"
+#include "batch.h"
+
+// Packed binary archive of boards.
+//
+// Layout (all integers little-endian):
+// - File header: magic `SDKB`, u16 version, u16 reserved, u64 record count
+// - Records, each:
+//   - u8 `n`
+//   - given mask, one bit per cell (`n * n` bits, padded to a byte)
+//   - solution, `CellBits(n)` bits per cell (padded to a byte). Cells without
+//     a known value are 0.
+// - Index: u64 byte offset of every record
+// - Trailer: u64 byte offset of the index
+//
+// Records can be read one after another, or by number through the index.
+
+// 4 bits per cell up to 15x15, 5 bits for 16x16 and 25x25
+inline size_t CellBits(size_t n) { return n < 16 ? 4 : 5; }
+size_t RecordSize(size_t n);
+
+class ArchiveWriter {
+private:
+    std::ofstream f;
+    std::vector<uint64_t> offsets;
+    uint64_t offset;
+    std::vector<uint8_t> record;
+    bool closed;
+public:
+    // Throws `std::invalid_argument` if the file can't be created
+    ArchiveWriter(std::string filename);
+    ~ArchiveWriter();
+
+    // Appends the problem's givens along with `solution`. Without a solution
+    // only the givens are stored.
+    void Write(Problem& problem, const State* solution = nullptr);
+
+    // Writes the index. Called by the destructor if needed.
+    void Close();
+    inline size_t Size() { return offsets.size(); }
+};
+
+class ArchiveReader {
+private:
+    MappedFile file;
+    const uint8_t* index;
+    size_t count;
+    size_t next;
+    const uint8_t* cursor;
+    std::vector<int> givens;
+    std::vector<int> cells;
+
+    const uint8_t* Record(uint64_t offset);
+    void Decode(const uint8_t* record, Problem& problem, State* solution);
+public:
+    // Throws `std::invalid_argument` if the file isn't a valid archive
+    ArchiveReader(std::string filename);
+
+    inline size_t Size() { return count; }
+
+    // Streaming: loads the next record into `problem` (reusing it) and, if
+    // given, its solution into `solution`. Returns false at the end.
+    bool Next(Problem& problem, State* solution = nullptr);
+
+    // Random access through the index. Throws `std::invalid_argument` if the
+    // record's offset or size doesn't fit before the index.
+    void Read(size_t i, Problem& problem, State* solution = nullptr);
+    void Seek(size_t i);
+};
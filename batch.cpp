@@ -0,0 +1,328 @@
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "batch.h"
+#include "parse.h"
+#include "queue.h"
+
+MappedFile::MappedFile(std::string filename) : data(nullptr), size(0) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::invalid_argument("Couldn't open file `" + filename + "`");
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::invalid_argument("Couldn't stat file `" + filename + "`");
+    }
+    size = st.st_size;
+
+    if (size > 0) {
+        void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            throw std::invalid_argument("Couldn't map file `" + filename + "`");
+        }
+        madvise(p, size, MADV_SEQUENTIAL);
+        data = (const char*)p;
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data) munmap((void*)data, size);
+}
+
+namespace {
+    // One puzzle in flight through the pipeline. Jobs are allocated once and
+    // recycled, so their buffers are reused.
+    struct Job {
+        size_t seq;
+        size_t n;
+        std::vector<int> cells;
+        bool solved;
+        std::string line;
+    };
+
+    // Sent to the workers instead of a job index once parsing is done
+    const uint32_t stop_job = UINT32_MAX;
+
+    // Jobs in flight per worker. Larger values absorb slow puzzles that hold
+    // up the reorder buffer, at the cost of memory.
+    const size_t jobs_per_worker = 16;
+
+    typedef BoundedQueue<uint32_t> JobQueue;
+    typedef std::chrono::steady_clock Clock;
+
+    // Per-thread stage counters, merged into `StageStats` at the end
+    struct StageCounters {
+        double stall_seconds = 0;
+        size_t pops = 0;
+        size_t depth_sum = 0;
+        size_t depth_max = 0;
+    };
+
+    void Push(JobQueue& queue, uint32_t job, StageCounters& counters) {
+        if (queue.TryPush(job)) return;
+        auto start = Clock::now();
+        while (!queue.TryPush(job)) std::this_thread::yield();
+        counters.stall_seconds +=
+            std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Waits for a job. Returns false without one if `done()` becomes true
+    // while the queue is empty.
+    template<class Done>
+    bool Pop(
+        JobQueue& queue,
+        uint32_t& job,
+        StageCounters& counters,
+        Done done
+    ) {
+        if (!queue.TryPop(job)) {
+            auto start = Clock::now();
+            bool ok = true;
+            while (!queue.TryPop(job)) {
+                if (done()) {
+                    ok = false;
+                    break;
+                }
+                std::this_thread::yield();
+            }
+            counters.stall_seconds +=
+                std::chrono::duration<double>(Clock::now() - start).count();
+            if (!ok) return false;
+        }
+        size_t depth = queue.Depth();
+        counters.pops++;
+        counters.depth_sum += depth;
+        counters.depth_max = std::max(counters.depth_max, depth);
+        return true;
+    }
+
+    bool Never() { return false; }
+
+    void AddStage(
+        BatchStats& stats,
+        std::string name,
+        const std::vector<StageCounters>& threads
+    ) {
+        StageStats stage;
+        stage.name = name;
+        stage.threads = threads.size();
+        size_t pops = 0;
+        size_t depth_sum = 0;
+        for (auto& counters : threads) {
+            stage.stall_seconds += counters.stall_seconds;
+            pops += counters.pops;
+            depth_sum += counters.depth_sum;
+            stage.queue_depth_max = std::max(
+                stage.queue_depth_max, counters.depth_max
+            );
+        }
+        stage.queue_depth_mean = pops > 0 ? (double)depth_sum / pops : 0;
+        stats.stages.push_back(stage);
+    }
+}
+
+BatchStats ProcessBatchGroups(
+    const char* begin,
+    const char* end,
+    std::ostream& out,
+    std::function<void(BatchGroup&)> process,
+    size_t group_size,
+    size_t n_workers
+) {
+    auto start = Clock::now();
+    if (n_workers == 0) n_workers = 1;
+    if (group_size == 0) group_size = 1;
+
+    // Every job index is always in exactly one place: a queue, a stage, or
+    // the reorder buffer
+    size_t n_jobs = std::max(jobs_per_worker, 2 * group_size) * n_workers;
+    std::vector<Job> jobs(n_jobs);
+    JobQueue free_jobs(n_jobs);
+    JobQueue parsed(n_jobs + n_workers);
+    JobQueue processed(n_jobs);
+    for (size_t i = 0; i < n_jobs; ++i) free_jobs.TryPush(i);
+
+    // Set by the parser once every line has been read
+    std::atomic<size_t> total(SIZE_MAX);
+    // First malformed line, if any
+    const char* error = nullptr;
+    ParseStatus error_status = ParseStatus::Ok;
+
+    std::vector<StageCounters> parse_counters(1);
+    std::vector<StageCounters> process_counters(n_workers);
+    std::vector<StageCounters> write_counters(1);
+
+    std::thread parser([&] () {
+        StageCounters& counters = parse_counters[0];
+        size_t seq = 0;
+        const char* p = begin;
+        while (p < end) {
+            const char* newline = (const char*)memchr(p, '\n', end - p);
+            const char* line_end = newline ? newline : end;
+            const char* line = p;
+            p = line_end + 1;
+
+            // Skip blank lines
+            const char* c = line;
+            while (c < line_end && (*c == ' ' || *c == '\t' || *c == '\r')) {
+                c++;
+            }
+            if (c == line_end) continue;
+
+            uint32_t i;
+            Pop(free_jobs, i, counters, Never);
+            Job& job = jobs[i];
+            ParseStatus status = ParseLine(
+                line, line_end, job.n, job.cells
+            );
+            if (status != ParseStatus::Ok) {
+                error = line;
+                error_status = status;
+                free_jobs.TryPush(i);
+                break;
+            }
+            job.seq = seq++;
+            Push(parsed, i, counters);
+        }
+        total.store(seq, std::memory_order_release);
+        for (size_t w = 0; w < n_workers; ++w) {
+            Push(parsed, stop_job, counters);
+        }
+    });
+
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < n_workers; ++w) {
+        workers.push_back(std::thread([&, w] () {
+            StageCounters& counters = process_counters[w];
+            BatchGroup group;
+            group.problems.resize(group_size);
+            group.lines.resize(group_size);
+            group.solved.resize(group_size);
+            std::vector<uint32_t> taken;
+            bool stopping = false;
+            uint32_t i;
+            while (!stopping && Pop(parsed, i, counters, Never)) {
+                if (i == stop_job) break;
+                // Wait for one job, then take whatever else is ready
+                taken.assign(1, i);
+                while (taken.size() < group_size && parsed.TryPop(i)) {
+                    if (i == stop_job) {
+                        stopping = true;
+                        break;
+                    }
+                    taken.push_back(i);
+                }
+
+                group.size = taken.size();
+                for (size_t k = 0; k < group.size; ++k) {
+                    Job& job = jobs[taken[k]];
+                    group.problems[k].Init(job.n, job.cells);
+                }
+                process(group);
+                for (size_t k = 0; k < group.size; ++k) {
+                    Job& job = jobs[taken[k]];
+                    job.line.swap(group.lines[k]);
+                    job.solved = group.solved[k];
+                    Push(processed, taken[k], counters);
+                }
+            }
+        }));
+    }
+
+    // Write on this thread. Jobs are issued in order and only recycled once
+    // written, so every job in flight has `seq` within `n_jobs` of `next`, and
+    // `seq % n_jobs` is a free slot in the reorder buffer.
+    BatchStats stats;
+    StageCounters& counters = write_counters[0];
+    std::vector<uint32_t> reorder(n_jobs, stop_job);
+    std::string buffer;
+    size_t next = 0;
+    auto done = [&] () {
+        return next == total.load(std::memory_order_acquire);
+    };
+    uint32_t i;
+    while (!done() && Pop(processed, i, counters, done)) {
+        reorder[jobs[i].seq % n_jobs] = i;
+        while (reorder[next % n_jobs] != stop_job) {
+            uint32_t j = reorder[next % n_jobs];
+            reorder[next % n_jobs] = stop_job;
+            Job& job = jobs[j];
+            buffer += job.line;
+            buffer += '\n';
+            stats.solved += job.solved;
+            next++;
+            Push(free_jobs, j, counters);
+        }
+        if (buffer.size() >= (1 << 16)) {
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), buffer.size());
+    out.flush();
+
+    parser.join();
+    for (auto& t : workers) t.join();
+
+    if (error) {
+        const char* line_end = (const char*)memchr(error, '\n', end - error);
+        if (!line_end) line_end = end;
+        throw std::invalid_argument(
+            "Invalid puzzle at byte " + std::to_string(error - begin) +
+            " (" + ParseStatusMessage(error_status) + "): `" +
+            std::string(error, line_end) + "`"
+        );
+    }
+
+    stats.puzzles = next;
+    AddStage(stats, "parse", parse_counters);
+    AddStage(stats, "process", process_counters);
+    AddStage(stats, "write", write_counters);
+    stats.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return stats;
+}
+
+BatchStats ProcessBatch(
+    const char* begin,
+    const char* end,
+    std::ostream& out,
+    std::function<bool(Problem&, std::string&)> process,
+    size_t n_workers
+) {
+    auto process_group = [&process] (BatchGroup& group) {
+        group.solved[0] = process(group.problems[0], group.lines[0]);
+    };
+    return ProcessBatchGroups(begin, end, out, process_group, 1, n_workers);
+}
+
+BatchStats SolveBatch(
+    const char* begin,
+    const char* end,
+    std::ostream& out,
+    std::function<Checkpoint(Problem&)> solve,
+    size_t n_workers
+) {
+    auto process = [&solve] (Problem& problem, std::string& line) {
+        Checkpoint checkpoint = solve(problem);
+        FormatBoard(
+            checkpoint.is_goal ? checkpoint.best.data : problem.fixed,
+            problem.n,
+            line
+        );
+        return checkpoint.is_goal;
+    };
+    return ProcessBatch(begin, end, out, process, n_workers);
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <ostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include "lib.h"
+
+// Read-only memory mapping of a whole file. Throws `std::invalid_argument`
+// if the file can't be opened or mapped.
+class MappedFile {
+private:
+    const char* data;
+    size_t size;
+public:
+    MappedFile(std::string filename);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator =(const MappedFile&) = delete;
+
+    inline const char* Begin() { return data; }
+    inline const char* End() { return data + size; }
+    inline size_t Size() { return size; }
+};
+
+// Counters for one stage of the batch pipeline. A stage stalls when its
+// input queue is empty or its output queue is full.
+struct StageStats {
+    std::string name;
+    size_t threads = 0;
+    double stall_seconds = 0;
+    // Jobs waiting in the stage's input queue, sampled on every pop
+    double queue_depth_mean = 0;
+    size_t queue_depth_max = 0;
+};
+
+struct BatchStats {
+    size_t puzzles = 0;
+    size_t solved = 0;
+    double seconds = 0;
+    // Parse, process and write, in pipeline order
+    std::vector<StageStats> stages;
+
+    inline double PuzzlesPerSecond() {
+        return seconds > 0 ? puzzles / seconds : 0;
+    }
+};
+
+// Runs `process` on every puzzle in [begin, end), one per line in any
+// single-line format accepted by `ParseLine`. `process` writes the output
+// line for the puzzle (without the newline) and returns whether it counts as
+// solved. Lines are written to `out` in input order.
+//
+// Runs as a pipeline: one thread parses lines, `n_workers` threads process
+// them and the calling thread writes the results. The stages pass jobs
+// through bounded lock-free queues, and a reorder buffer restores input
+// order before writing. `process` is called concurrently from the workers,
+// each with its own `Problem` that is reused for every puzzle.
+BatchStats ProcessBatch(
+    const char* begin,
+    const char* end,
+    std::ostream& out,
+    std::function<bool(Problem&, std::string&)> process,
+    size_t n_workers = 1
+);
+
+// Puzzles handed to a worker together, for solvers that work on several at
+// once. Only the first `size` entries are in use; `process` fills in the
+// output line and solved flag of each.
+struct BatchGroup {
+    size_t size = 0;
+    std::vector<Problem> problems;
+    std::vector<std::string> lines;
+    std::vector<bool> solved;
+};
+
+// Like `ProcessBatch`, but each worker takes up to `group_size` puzzles at a
+// time: it waits for one, then adds whatever else is already parsed
+BatchStats ProcessBatchGroups(
+    const char* begin,
+    const char* end,
+    std::ostream& out,
+    std::function<void(BatchGroup&)> process,
+    size_t group_size,
+    size_t n_workers = 1
+);
+
+// Solves every puzzle with `ProcessBatch`. Each output line is the
+// solution, or the puzzle itself if `solve` didn't reach the goal.
+BatchStats SolveBatch(
+    const char* begin,
+    const char* end,
+    std::ostream& out,
+    std::function<Checkpoint(Problem&)> solve,
+    size_t n_workers = 1
+);
@@ -0,0 +1,58 @@
+#include <algorithm>
+#include <cstdint>
+#include "budget.h"
+
+namespace {
+    const auto clock_gap = std::chrono::microseconds(50);
+    const size_t max_stride = 1 << 16;
+}
+
+const char* BudgetStopName(BudgetStop stop) {
+    switch (stop) {
+        case BudgetStop::None: return "none";
+        case BudgetStop::Deadline: return "deadline";
+        case BudgetStop::Evals: return "evals";
+        case BudgetStop::Cancelled: return "cancelled";
+    }
+    return "unknown";
+}
+
+Budget Budget::Within(double seconds) {
+    Budget budget;
+    budget.deadline = Clock::now() + std::chrono::duration_cast<
+        Clock::duration
+    >(std::chrono::duration<double>(seconds));
+    return budget;
+}
+
+BudgetCheck::BudgetCheck(const Budget& budget) :
+    budget(budget),
+    countdown(1),
+    stride(1),
+    last(Budget::Clock::now()),
+    stop(BudgetStop::None) {
+    // Without a deadline the clock is never read
+    if (budget.deadline == Budget::Clock::time_point::max()) {
+        countdown = SIZE_MAX;
+    }
+}
+
+void BudgetCheck::ReadClock() {
+    auto now = Budget::Clock::now();
+    if (now >= budget.deadline) {
+        stop = BudgetStop::Deadline;
+        return;
+    }
+
+    auto gap = now - last;
+    last = now;
+    if (budget.deadline - now < 2 * gap) {
+        // Close to the deadline, check every step
+        stride = 1;
+    } else if (gap < clock_gap) {
+        stride = std::min(stride * 2, max_stride);
+    } else if (stride > 1) {
+        stride /= 2;
+    }
+    countdown = stride;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+// Why a solver stopped early
+enum class BudgetStop {
+    None,
+    Deadline,
+    Evals,
+    Cancelled
+};
+
+const char* BudgetStopName(BudgetStop stop);
+
+// Limits on a solver run, set through `Problem::budget`. A solver that runs
+// out returns the best state it found so far, with `Checkpoint::stopped`
+// saying why. The default has no limits.
+struct Budget {
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point deadline = Clock::time_point::max();
+    // Per solver call, 0 for no limit. Counted as successors and restarts
+    // for the hill climber, population members for the genetic algorithm
+    // (memo hits included) and search nodes for the exact search (across
+    // every thread, see `ExactSearch::Limit`).
+    size_t max_evals = 0;
+    // Set from another thread to stop the solver
+    const std::atomic<bool>* cancel = nullptr;
+
+    // No limits but a deadline `seconds` from now
+    static Budget Within(double seconds);
+};
+
+// Checks a budget from one thread. The clock is read only every `stride`
+// checks: the stride doubles while reads are less than `clock_gap` apart
+// and halves when they are further apart, so most checks are a decrement
+// and the deadline is overshot by about `clock_gap` plus one solver step.
+class BudgetCheck {
+private:
+    const Budget& budget;
+    size_t countdown;
+    size_t stride;
+    Budget::Clock::time_point last;
+
+    void ReadClock();
+
+public:
+    BudgetStop stop;
+
+    explicit BudgetCheck(const Budget& budget);
+
+    // `evals` is the count so far in this solver call
+    inline bool Exhausted(size_t evals) {
+        if (stop != BudgetStop::None) return true;
+        if (budget.cancel && budget.cancel->load(std::memory_order_relaxed)) {
+            stop = BudgetStop::Cancelled;
+        } else if (budget.max_evals > 0 && evals >= budget.max_evals) {
+            stop = BudgetStop::Evals;
+        } else if (--countdown == 0) {
+            ReadClock();
+        }
+        return stop != BudgetStop::None;
+    }
+};
@@ -0,0 +1,408 @@
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <cmath>
+#include <algorithm>
+#include "exact.h"
+
+ExactSearch::ExactSearch() :
+    n(0),
+    valid(false),
+    limit(0),
+    count(nullptr),
+    solution(nullptr),
+    branches(0),
+    rand_gen(nullptr),
+    budget(nullptr),
+    check(nullptr),
+    nodes(0),
+    shared_nodes(nullptr),
+    shared_seen(0),
+    unshared(0),
+    stopped(BudgetStop::None),
+    pool(nullptr),
+    worker(0) { }
+
+void ExactSearch::Load(size_t n, const std::vector<int>& cells) {
+    size_t box = (size_t)std::round(std::sqrt((double)n));
+    if (n != this->n) {
+        this->n = n;
+        cell_row.resize(n * n);
+        cell_col.resize(n * n);
+        cell_box.resize(n * n);
+        for (size_t i = 0; i < n * n; ++i) {
+            size_t row = i / n;
+            size_t col = i % n;
+            cell_row[i] = row;
+            cell_col[i] = col;
+            cell_box[i] = ((row / box) * box) + (col / box);
+        }
+    }
+    // Values are bits 1 to `n`; every other bit counts as used, so it never
+    // shows up as a candidate
+    uint32_t unused = ~(((1u << n) - 1) << 1);
+    rows.assign(n, unused);
+    cols.assign(n, unused);
+    boxes.assign(n, unused);
+    board = cells;
+    blanks.clear();
+    valid = true;
+
+    for (size_t i = 0; i < n * n; ++i) {
+        int value = cells[i];
+        if (value == 0) {
+            blanks.push_back(i);
+        } else if (~Candidates(i) & (1u << value)) {
+            valid = false;
+        } else {
+            Place(i, value);
+        }
+    }
+}
+
+inline void ExactSearch::Place(int i, int value) {
+    uint32_t bit = 1u << value;
+    rows[cell_row[i]] |= bit;
+    cols[cell_col[i]] |= bit;
+    boxes[cell_box[i]] |= bit;
+    board[i] = value;
+}
+
+inline void ExactSearch::Unplace(int i, int value) {
+    uint32_t bit = ~(1u << value);
+    rows[cell_row[i]] &= bit;
+    cols[cell_col[i]] &= bit;
+    boxes[cell_box[i]] &= bit;
+    board[i] = 0;
+}
+
+// Nodes so far against the budget: in this call, or in every search adding
+// to `shared_nodes`
+inline size_t ExactSearch::CountNode() {
+    ++nodes;
+    if (!shared_nodes) return nodes;
+    if (++unshared == node_batch) ShareNodes();
+    return shared_seen + unshared;
+}
+
+void ExactSearch::ShareNodes() {
+    shared_seen = shared_nodes->fetch_add(
+        unshared, std::memory_order_relaxed
+    ) + unshared;
+    unshared = 0;
+}
+
+void ExactSearch::Search(size_t depth) {
+    if (check && check->Exhausted(CountNode())) return;
+    if (depth == blanks.size()) {
+        if (count->fetch_add(1) == 0 && solution) *solution = board;
+        return;
+    }
+
+    // Branch on the blank with the fewest candidates
+    size_t best = depth;
+    int best_count = INT32_MAX;
+    for (size_t d = depth; d < blanks.size(); ++d) {
+        int c = __builtin_popcount(Candidates(blanks[d]));
+        if (c < best_count) {
+            best = d;
+            best_count = c;
+            if (c <= 1) break;
+        }
+    }
+    if (best_count == 0) return;
+    if (best_count > 1) branches++;
+    std::swap(blanks[depth], blanks[best]);
+
+    if (rand_gen) {
+        BranchShuffled(blanks[depth], depth);
+    } else {
+        Branch(blanks[depth], depth);
+    }
+}
+
+void ExactSearch::Branch(int i, size_t depth) {
+    uint32_t candidates = Candidates(i);
+    while (candidates) {
+        int value = __builtin_ctz(candidates);
+        candidates &= candidates - 1;
+        // Only shallow subtrees are worth the copy
+        bool shallow = depth * 2 < blanks.size();
+        if (candidates && pool && shallow && pool->Hungry()) {
+            Donate(i, candidates);
+            candidates = 0;
+        }
+        Place(i, value);
+        Search(depth + 1);
+        Unplace(i, value);
+        if (limit > 0 && count->load(std::memory_order_relaxed) >= limit) {
+            break;
+        }
+        if (check && check->stop != BudgetStop::None) break;
+    }
+}
+
+void ExactSearch::BranchShuffled(int i, size_t depth) {
+    int values[32];
+    size_t n_values = 0;
+    uint32_t candidates = Candidates(i);
+    while (candidates) {
+        values[n_values++] = __builtin_ctz(candidates);
+        candidates &= candidates - 1;
+    }
+    std::shuffle(values, values + n_values, *rand_gen);
+
+    for (size_t v = 0; v < n_values; ++v) {
+        Place(i, values[v]);
+        Search(depth + 1);
+        Unplace(i, values[v]);
+        if (limit > 0 && count->load(std::memory_order_relaxed) >= limit) {
+            break;
+        }
+        if (check && check->stop != BudgetStop::None) break;
+    }
+}
+
+void ExactSearch::Donate(int i, uint32_t candidates) {
+    while (candidates) {
+        std::vector<int> part = board;
+        part[i] = __builtin_ctz(candidates);
+        candidates &= candidates - 1;
+        pool->Give(worker, std::move(part));
+    }
+}
+
+size_t ExactSearch::Count(size_t limit, std::vector<int>* solution) {
+    std::atomic<size_t> count(0);
+    Count(limit, count, solution);
+    return count;
+}
+
+void ExactSearch::Count(
+    size_t limit,
+    std::atomic<size_t>& count,
+    std::vector<int>* solution
+) {
+    branches = 0;
+    stopped = BudgetStop::None;
+    if (!valid) return;
+    if (limit > 0 && count.load() >= limit) return;
+    this->limit = limit;
+    this->count = &count;
+    this->solution = solution;
+    nodes = 0;
+    if (!budget) {
+        Search(0);
+        return;
+    }
+
+    BudgetCheck budget_check(*budget);
+    check = &budget_check;
+    if (shared_nodes) shared_seen = shared_nodes->load();
+    Search(0);
+    if (shared_nodes) ShareNodes();
+    stopped = budget_check.stop;
+    check = nullptr;
+}
+
+std::vector<std::vector<int>> ExactSearch::Split(size_t n_parts) {
+    std::deque<std::vector<int>> parts;
+    if (!valid) return {};
+    parts.push_back(board);
+
+    // Breadth first, so the subtrees stay roughly even
+    size_t expanded = 0;
+    while (parts.size() < n_parts && expanded < parts.size()) {
+        std::vector<int> part = parts.front();
+        parts.pop_front();
+        Load(n, part);
+        if (!valid || blanks.empty()) {
+            // Solved or dead; keep it so the count includes it
+            parts.push_back(part);
+            expanded++;
+            continue;
+        }
+        expanded = 0;
+
+        size_t best = 0;
+        int best_count = INT32_MAX;
+        for (size_t d = 0; d < blanks.size(); ++d) {
+            int c = __builtin_popcount(Candidates(blanks[d]));
+            if (c < best_count) {
+                best = d;
+                best_count = c;
+            }
+        }
+        int i = blanks[best];
+        uint32_t candidates = Candidates(i);
+        while (candidates) {
+            int value = __builtin_ctz(candidates);
+            candidates &= candidates - 1;
+            part[i] = value;
+            parts.push_back(part);
+        }
+    }
+    return std::vector<std::vector<int>>(parts.begin(), parts.end());
+}
+
+SplitPool::SplitPool(size_t n_workers) :
+    workers(n_workers),
+    pending(0),
+    idle(0),
+    halted(false) { }
+
+void SplitPool::Give(size_t worker, std::vector<int>&& part) {
+    pending++;
+    std::lock_guard<std::mutex> lock(workers[worker].mutex);
+    workers[worker].parts.push_back(std::move(part));
+}
+
+bool SplitPool::TakeFrom(
+    size_t worker,
+    bool newest,
+    std::vector<int>& part
+) {
+    std::lock_guard<std::mutex> lock(workers[worker].mutex);
+    std::deque<std::vector<int>>& parts = workers[worker].parts;
+    if (parts.empty()) return false;
+    if (newest) {
+        part = std::move(parts.back());
+        parts.pop_back();
+    } else {
+        part = std::move(parts.front());
+        parts.pop_front();
+    }
+    return true;
+}
+
+bool SplitPool::Take(size_t worker, std::vector<int>& part) {
+    const size_t n = workers.size();
+    bool waiting = false;
+    bool taken = false;
+    while (!halted) {
+        taken = TakeFrom(worker, true, part);
+        for (size_t k = 1; k < n && !taken; ++k) {
+            taken = TakeFrom((worker + k) % n, false, part);
+        }
+        // Nothing queued and nothing being searched that could be split
+        if (taken || pending == 0) break;
+        if (!waiting) {
+            waiting = true;
+            idle++;
+        }
+        std::this_thread::yield();
+    }
+    if (waiting) idle--;
+    return taken;
+}
+
+namespace {
+    // Counts until `limit` or until the budget runs out (nullptr for none).
+    // `nodes` is set to the search nodes, across every thread.
+    size_t CountWithin(
+        Problem& problem,
+        size_t limit,
+        std::vector<int>* solution,
+        size_t n_threads,
+        const Budget* budget,
+        BudgetStop& stopped,
+        size_t& nodes
+    ) {
+        ExactSearch search;
+        search.Limit(budget);
+        search.Load(problem.n, problem.fixed);
+        stopped = BudgetStop::None;
+        if (n_threads <= 1) {
+            size_t count = search.Count(limit, solution);
+            stopped = search.Stopped();
+            nodes = search.Nodes();
+            return count;
+        }
+
+        // A few subtrees per thread to start with; searches split theirs
+        // further while a thread is idle
+        std::vector<std::vector<int>> parts = search.Split(n_threads * 4);
+        SplitPool pool(n_threads);
+        for (size_t i = 0; i < parts.size(); ++i) {
+            pool.Give(i % n_threads, std::move(parts[i]));
+        }
+
+        std::atomic<size_t> count(0);
+        // One node count for the whole search, so `max_evals` limits it
+        // rather than each subtree
+        std::atomic<size_t> shared_nodes(0);
+        std::mutex stopped_mutex;
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < n_threads; ++t) {
+            threads.push_back(std::thread([&, t] () {
+                ExactSearch search;
+                search.Limit(budget, &shared_nodes);
+                search.Share(&pool, t);
+                std::vector<int> part;
+                while (pool.Take(t, part)) {
+                    search.Load(problem.n, part);
+                    search.Count(limit, count, solution);
+                    pool.Done();
+                    if (search.Stopped() != BudgetStop::None) {
+                        // Every thread stops at the same deadline or cancel
+                        std::lock_guard<std::mutex> lock(stopped_mutex);
+                        stopped = search.Stopped();
+                        pool.Halt();
+                        break;
+                    }
+                    if (limit > 0 && count >= limit) pool.Halt();
+                }
+            }));
+        }
+        for (auto& t : threads) t.join();
+
+        nodes = shared_nodes;
+        size_t total = count;
+        return limit > 0 ? std::min(total, limit) : total;
+    }
+}
+
+size_t CountSolutions(
+    Problem& problem,
+    size_t limit,
+    std::vector<int>* solution,
+    size_t n_threads
+) {
+    BudgetStop stopped;
+    size_t nodes;
+    return CountWithin(
+        problem, limit, solution, n_threads, nullptr, stopped, nodes
+    );
+}
+
+size_t CountSolutionsWithin(
+    Problem& problem,
+    size_t limit,
+    size_t n_threads,
+    BudgetStop& stopped
+) {
+    size_t nodes;
+    return CountWithin(
+        problem, limit, nullptr, n_threads, &problem.budget, stopped, nodes
+    );
+}
+
+Checkpoint SolveExact(Problem& problem, size_t n_threads) {
+    std::vector<int> solution;
+    Checkpoint checkpoint;
+    PhaseTimer timer(checkpoint.stats.total_time);
+    size_t nodes = 0;
+    checkpoint.is_goal = CountWithin(
+        problem, 1, &solution, n_threads, &problem.budget,
+        checkpoint.stopped, nodes
+    ) > 0;
+    Tally(checkpoint.stats.evals, nodes);
+    checkpoint.best = State(&problem);
+    if (checkpoint.is_goal) {
+        for (size_t i = 0; i < solution.size(); ++i) {
+            if (!problem.IsFixed(i)) checkpoint.best.Set(i, solution[i]);
+        }
+    }
+    timer.Stop();
+    return checkpoint;
+}
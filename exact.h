@@ -0,0 +1,184 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <cstdint>
+#include "lib.h"
+
+// Subtrees of one search shared by worker threads. Each worker takes the
+// newest subtree from its own deque, and when that runs dry steals the
+// oldest (so usually the largest) one from another worker's deque.
+class SplitPool {
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::vector<int>> parts;
+    };
+    std::vector<Worker> workers;
+    // Subtrees given but not yet searched to the end
+    std::atomic<size_t> pending;
+    // Workers waiting in `Take`
+    std::atomic<size_t> idle;
+    std::atomic<bool> halted;
+
+    bool TakeFrom(size_t worker, bool newest, std::vector<int>& part);
+
+public:
+    SplitPool(size_t n_workers);
+
+    void Give(size_t worker, std::vector<int>&& part);
+
+    // Waits for a subtree for `worker`. Returns false once every subtree has
+    // been searched, or the pool was halted.
+    bool Take(size_t worker, std::vector<int>& part);
+
+    // Marks a taken subtree as searched, after any subtrees it gave away
+    inline void Done() { pending--; }
+
+    // Makes every `Take` return false, e.g. once enough solutions are found
+    inline void Halt() { halted = true; }
+
+    // Some worker waits for work, so searches should give some away
+    inline bool Hungry() {
+        return idle.load(std::memory_order_relaxed) > 0;
+    }
+};
+
+// Exact backtracking search over bit masks. Each row, column and box keeps
+// a mask of the values it already holds, and the search always branches on
+// the blank with the fewest candidates (minimum remaining values).
+//
+// Unlike `HillClimber` and `Genetic` it can prove that a puzzle has no
+// solution, or count how many it has.
+class ExactSearch {
+private:
+    size_t n;
+    std::vector<int> board;
+    std::vector<uint32_t> rows;
+    std::vector<uint32_t> cols;
+    std::vector<uint32_t> boxes;
+    // Row, column and box of every cell
+    std::vector<uint16_t> cell_row;
+    std::vector<uint16_t> cell_col;
+    std::vector<uint16_t> cell_box;
+    // Blank cells. Cells before the current depth are filled.
+    std::vector<int> blanks;
+    bool valid;
+
+    size_t limit;
+    std::atomic<size_t>* count;
+    std::vector<int>* solution;
+    size_t branches;
+    std::mt19937_64* rand_gen;
+    const Budget* budget;
+    BudgetCheck* check;
+    size_t nodes;
+    std::atomic<size_t>* shared_nodes;
+    // Shared total when last added to, and nodes since
+    size_t shared_seen;
+    size_t unshared;
+    BudgetStop stopped;
+    SplitPool* pool;
+    size_t worker;
+
+    inline uint32_t Candidates(int i) {
+        return ~(rows[cell_row[i]] | cols[cell_col[i]] | boxes[cell_box[i]]);
+    }
+    inline void Place(int i, int value);
+    inline void Unplace(int i, int value);
+    inline size_t CountNode();
+    void ShareNodes();
+    void Search(size_t depth);
+    void Branch(int i, size_t depth);
+    void BranchShuffled(int i, size_t depth);
+    void Donate(int i, uint32_t candidates);
+
+public:
+    ExactSearch();
+
+    // Loads `n * n` cells (0 for blanks). A board whose givens already
+    // conflict has no solutions.
+    void Load(size_t n, const std::vector<int>& cells);
+
+    // Counts solutions, stopping once `limit` are found (0 for no limit).
+    // The first solution found is stored in `solution`, if given.
+    size_t Count(size_t limit, std::vector<int>* solution = nullptr);
+
+    // Like `Count`, but adds to a counter shared with other searches, and
+    // stops once the shared total reaches `limit`. The search that finds the
+    // first solution stores it.
+    void Count(
+        size_t limit,
+        std::atomic<size_t>& count,
+        std::vector<int>* solution
+    );
+
+    // Tries candidates in random order when given, e.g. to fill an empty
+    // board with a random grid. nullptr restores the fixed order.
+    inline void Shuffle(std::mt19937_64* rand_gen) {
+        this->rand_gen = rand_gen;
+    }
+
+    // Branch points with more than one candidate in the last `Count`, a rough
+    // measure of how much guessing a board needs
+    inline size_t Branches() { return branches; }
+
+    // Stops `Count` early when the budget runs out (nullptr for none), with
+    // `Stopped` saying why. Counts and solutions are then incomplete.
+    //
+    // With `shared_nodes`, `max_evals` limits the nodes of every search that
+    // adds to it. Nodes are added `node_batch` at a time, so the total can
+    // overshoot by up to a batch per search.
+    inline void Limit(
+        const Budget* budget,
+        std::atomic<size_t>* shared_nodes = nullptr
+    ) {
+        this->budget = budget;
+        this->shared_nodes = shared_nodes;
+    }
+    inline BudgetStop Stopped() { return stopped; }
+
+    // Search nodes in the last `Count`, only counted with a budget
+    inline size_t Nodes() { return nodes; }
+
+    static const size_t node_batch = 128;
+
+    // While a worker of `pool` is idle, gives it the untried candidates of
+    // shallow branch points as subtrees instead of trying them here
+    // (nullptr for no pool). Ignored with `Shuffle`.
+    inline void Share(SplitPool* pool, size_t worker) {
+        this->pool = pool;
+        this->worker = worker;
+    }
+
+    // Splits the loaded board's search tree into about `n_parts` subtrees,
+    // by branching on the most constrained blanks first. Each subtree is a
+    // board to `Load`. Leaves the search loaded with one of them.
+    std::vector<std::vector<int>> Split(size_t n_parts);
+};
+
+// Counts the problem's solutions up to `limit`, e.g. 2 to check that a
+// puzzle is unique. With `n_threads` > 1 the search tree is split into
+// subtrees for a `SplitPool`, and searches split theirs further whenever a
+// thread runs out of work.
+size_t CountSolutions(
+    Problem& problem,
+    size_t limit = 2,
+    std::vector<int>* solution = nullptr,
+    size_t n_threads = 1
+);
+
+// Like `CountSolutions`, but stops when `problem.budget` runs out, with
+// `stopped` saying why. The count is then only a lower bound.
+size_t CountSolutionsWithin(
+    Problem& problem,
+    size_t limit,
+    size_t n_threads,
+    BudgetStop& stopped
+);
+
+// Solves with the exact search, in the shape the other solvers return.
+// Unlike `CountSolutions` it stops when `problem.budget` runs out.
+Checkpoint SolveExact(Problem& problem, size_t n_threads = 1);
@@ -0,0 +1,60 @@
+#include <algorithm>
+#include "generate.h"
+
+Generator::Generator(uint64_t seed) : rand_gen(seed) { }
+
+bool Generator::Attempt(
+    const GeneratorOptions& options,
+    std::vector<int>& puzzle,
+    std::vector<int>& solution
+) {
+    size_t n = options.n;
+    size_t n_cells = n * n;
+
+    // Random complete grid
+    puzzle.assign(n_cells, 0);
+    search.Shuffle(&rand_gen);
+    search.Load(n, puzzle);
+    bool filled = search.Count(1, &solution) > 0;
+    search.Shuffle(nullptr);
+    if (!filled) return false;
+
+    // Remove givens while the solution stays unique
+    puzzle = solution;
+    order.resize(n_cells);
+    for (size_t i = 0; i < n_cells; ++i) order[i] = i;
+    std::shuffle(order.begin(), order.end(), rand_gen);
+
+    size_t givens = n_cells;
+    for (size_t k = 0; k < n_cells && givens > options.givens; ++k) {
+        int i = order[k];
+        int value = puzzle[i];
+        puzzle[i] = 0;
+        search.Load(n, puzzle);
+        if (search.Count(2) == 1) {
+            givens--;
+        } else {
+            puzzle[i] = value;
+        }
+    }
+    if (givens != options.givens) return false;
+
+    search.Load(n, puzzle);
+    search.Count(2);
+    return search.Branches() >= options.min_branches &&
+        search.Branches() <= options.max_branches;
+}
+
+bool Generator::Generate(
+    const GeneratorOptions& options,
+    std::vector<int>& puzzle,
+    std::vector<int>* solution
+) {
+    for (size_t attempt = 0; attempt < options.max_attempts; ++attempt) {
+        if (Attempt(options, puzzle, grid)) {
+            if (solution) *solution = grid;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include <random>
+#include <cstdint>
+#include "exact.h"
+
+struct GeneratorOptions {
+    size_t n = 9;
+    // Givens are removed until this many are left. Boards where no more can
+    // be removed without losing uniqueness first are thrown away.
+    size_t givens = 30;
+    // Difficulty band, as the number of branch points the exact search needs
+    // to prove the puzzle unique (see `ExactSearch::Branches`)
+    size_t min_branches = 0;
+    size_t max_branches = SIZE_MAX;
+    // Boards tried per puzzle before giving up
+    size_t max_attempts = 1000;
+};
+
+// Makes puzzles with a unique solution: fills a random complete grid with
+// the exact search, then removes givens in random order as long as the
+// solution stays unique.
+class Generator {
+private:
+    std::mt19937_64 rand_gen;
+    ExactSearch search;
+    std::vector<int> order;
+    std::vector<int> grid;
+
+    bool Attempt(
+        const GeneratorOptions& options,
+        std::vector<int>& puzzle,
+        std::vector<int>& solution
+    );
+public:
+    // The same seed gives the same puzzles
+    Generator(uint64_t seed);
+
+    // Writes a puzzle into `puzzle` and its solution into `solution`, if
+    // given. Returns false if no puzzle within the options was found in
+    // `options.max_attempts` boards.
+    bool Generate(
+        const GeneratorOptions& options,
+        std::vector<int>& puzzle,
+        std::vector<int>* solution = nullptr
+    );
+
+    // Branch points of the last puzzle generated
+    inline size_t Branches() { return search.Branches(); }
+};
@@ -1,11 +1,23 @@
 #include <iostream>
-#include <iomanip>
 #include <fstream>
-#include <unordered_set>
+#include <sstream>
 #include <algorithm>
 #include <thread>
+#include <chrono>
 #include <limits.h>
 #include "lib.h"
+#include "parse.h"
+#include "trace.h"
+#include "workers.h"
+
+namespace {
+    typedef std::chrono::steady_clock TraceClock;
+
+    double Since(TraceClock::time_point start) {
+        return std::chrono::duration<double>(TraceClock::now() - start)
+            .count();
+    }
+}
 
 size_t Index(size_t row, size_t col, size_t n) {
     return (row * n) + col;
@@ -21,35 +33,100 @@ void PrintBoard(std::vector<int> board, size_t n) {
     std::cout << std::endl;
 }
 
-Problem::Problem(std::string filename) {
+Problem::Problem(std::string filename) :
+    n(0),
+    n_fixed(0),
+    progress(nullptr),
+    trace(nullptr) {
     std::ifstream f(filename);
     if (!f.good()) {
         throw std::invalid_argument("Couldn't open file `" + filename + "`");
     }
 
-    std::string line;
-    getline(f, line);
+    std::stringstream text;
+    text << f.rdbuf();
+
+    size_t n;
+    std::vector<int> cells;
+    try {
+        cells = ParseBoard(text.str(), n);
+    } catch (std::invalid_argument& e) {
+        throw std::invalid_argument(
+            "Couldn't parse `" + filename + "`: " + e.what()
+        );
+    }
+    Init(n, cells);
+}
+
+Problem::Problem() :
+    n(0),
+    n_fixed(0),
+    progress(nullptr),
+    trace(nullptr) { }
 
-    size_t n = std::stoul(line);
+void Problem::Init(size_t n, const std::vector<int>& cells) {
+    // Reusing a problem for another board of the same size keeps the Zobrist
+    // keys
+    bool same_size = n == this->n && !zobrist.empty();
     this->n = n;
-    this->fixed = std::vector<int>(n * n);
+    this->fixed = cells;
     this->cell_value_dist = std::uniform_int_distribution<int>(1, n);
     this->n_fixed = 0;
+    for (int x : cells) {
+        if (x != 0) this->n_fixed++;
+    }
 
-    for (size_t row = 0; row < n; ++row) {
-        getline(f, line);
-        for (size_t col = 0; col < line.length(); ++col) {
-            char c = line[col];
-            if (c != '*') {
-                this->fixed[Index(row, col, n)] = c - '0';
-                this->n_fixed++;
-            }
-        }
+    if (same_size) return;
+
+    // Zobrist keys for every (cell, value) pair. Seeded with a constant so
+    // hashes are reproducible between runs.
+    this->zobrist = std::vector<uint64_t>(n * n * (n + 1));
+    uint64_t seed = 0x9e3779b97f4a7c15;
+    for (auto& key : this->zobrist) {
+        // splitmix64
+        uint64_t z = (seed += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        key = z ^ (z >> 31);
+    }
+}
+
+ParseStatus Problem::Load(const char* begin, const char* end) {
+    size_t n;
+    ParseStatus status = TryParseBoard(begin, end, n, load_cells);
+    if (status == ParseStatus::Ok) Init(n, load_cells);
+    return status;
+}
+
+ParseStatus Problem::Load(const std::string& text) {
+    return Load(text.data(), text.data() + text.size());
+}
+
+ParseStatus Problem::Load(size_t n, const int* cells) {
+    ParseStatus status = CheckBoard(n, cells);
+    if (status == ParseStatus::Ok) {
+        load_cells.assign(cells, cells + (n * n));
+        Init(n, load_cells);
     }
+    return status;
 }
 
 State::State(Problem* problem) : problem(problem) {
     data = problem->fixed;
+    Rehash();
+}
+
+void State::Set(size_t i, int value) {
+    hash ^= problem->Zobrist(i, data[i]) ^ problem->Zobrist(i, value);
+    data[i] = value;
+    eval.reset();
+}
+
+void State::Rehash() {
+    hash = 0;
+    for (size_t i = 0; i < data.size(); ++i) {
+        hash ^= problem->Zobrist(i, data[i]);
+    }
 }
 
 void State::Print() {
@@ -87,50 +164,229 @@ bool StateIter::FixParams(size_t& i, size_t& cell_value) {
 }
 
 tl::optional<State> StateIter::Successor() {
-    if (!FixParams(i, cell_value)) return tl::nullopt;
-    State ans = *state;
-    ans.data[i] = cell_value;
-    cell_value++;
+    State ans;
+    if (!Successor(ans)) return tl::nullopt;
     return tl::make_optional(ans);
 }
 
-std::random_device rand_dev;
-std::mt19937 rand_gen(rand_dev());
+bool StateIter::Successor(State& succ) {
+    if (!FixParams(i, cell_value)) return false;
+    succ = *state;
+    succ.Set(i, cell_value);
+    cell_value++;
+    return true;
+}
+
+Checkpoint::Checkpoint(Problem* problem, std::string filename) {
+    std::ifstream f(filename);
+    if (!f.good()) {
+        throw std::invalid_argument("Couldn't open file `" + filename + "`");
+    }
+
+    size_t n;
+    size_t n_states;
+    f >> n >> is_goal >> iter >> restarts >> n_states;
+    if (!f || n != problem->n) {
+        throw std::invalid_argument(
+            "Checkpoint `" + filename + "` doesn't match the problem"
+        );
+    }
+
+    // The best state comes first, followed by the population
+    std::vector<State> states;
+    for (size_t s = 0; s < n_states + 1; ++s) {
+        State state(problem);
+        for (size_t i = 0; i < state.data.size(); ++i) {
+            int value;
+            f >> value;
+            if (!f || value < 0 || value > (int)n) {
+                throw std::invalid_argument(
+                    "Invalid state in checkpoint `" + filename + "`"
+                );
+            }
+            if (!problem->IsFixed(i)) {
+                state.Set(i, value);
+            }
+        }
+        states.push_back(state);
+    }
+
+    best = states[0];
+    population = std::vector<State>(states.begin() + 1, states.end());
+}
+
+void Checkpoint::Save(std::string filename) {
+    std::ofstream f(filename);
+    if (!f.good()) {
+        throw std::invalid_argument("Couldn't open file `" + filename + "`");
+    }
+
+    Problem* problem = best.problem;
+    if (!problem && !population.empty()) problem = population[0].problem;
+    if (!problem) {
+        throw std::invalid_argument("Can't save an empty checkpoint");
+    }
+
+    f <<
+        problem->n << " " << is_goal << " " << iter << " " <<
+        restarts << " " << population.size() << "\n";
+
+    // The best state comes first, followed by the population
+    State blank(problem);
+    std::vector<const State*> states(1, best.problem ? &best : &blank);
+    for (auto& s : population) states.push_back(&s);
+
+    for (auto state : states) {
+        for (size_t i = 0; i < state->data.size(); ++i) {
+            if (i > 0) f << " ";
+            f << state->data[i];
+        }
+        f << "\n";
+    }
+}
+
+HashIndex::HashIndex(size_t capacity) : count(0), lookups(0), hits(0) {
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    mask = size - 1;
+    keys.reset(new std::atomic<uint64_t>[size]);
+    values.reset(new std::atomic<int>[size]);
+    Clear();
+}
+
+bool HashIndex::Insert(uint64_t key, int value) {
+    if (key == 0) key = 1; // 0 marks an empty slot
+    for (size_t probe = 0; probe < max_probes; ++probe) {
+        size_t slot = (key + probe) & mask;
+        uint64_t expected = keys[slot].load(std::memory_order_acquire);
+        if (expected == 0) {
+            if (keys[slot].compare_exchange_strong(expected, key)) {
+                values[slot].store(value, std::memory_order_release);
+                count++;
+                return true;
+            }
+            // Lost the race for this slot, `expected` now holds the winner
+        }
+        if (expected == key) {
+            if (value != pending) {
+                values[slot].store(value, std::memory_order_release);
+            }
+            return false;
+        }
+    }
+    // Probe sequence is full, behave as if the key was new
+    return true;
+}
+
+bool HashIndex::Find(uint64_t key, int& value) {
+    if (key == 0) key = 1;
+    lookups++;
+    for (size_t probe = 0; probe < max_probes; ++probe) {
+        size_t slot = (key + probe) & mask;
+        uint64_t slot_key = keys[slot].load(std::memory_order_acquire);
+        if (slot_key == 0) return false;
+        if (slot_key == key) {
+            int slot_value = values[slot].load(std::memory_order_acquire);
+            if (slot_value == pending) return false;
+            value = slot_value;
+            hits++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void HashIndex::Clear() {
+    for (size_t slot = 0; slot <= mask; ++slot) {
+        keys[slot].store(0, std::memory_order_relaxed);
+        values[slot].store(pending, std::memory_order_relaxed);
+    }
+    count = 0;
+}
+
+// Per thread, so that concurrent solvers (GA workers, batch workers) don't
+// share a generator. Seeded from `rand_dev` unless `SeedRandom` is called.
+thread_local std::random_device rand_dev;
+thread_local std::mt19937 rand_gen(rand_dev());
+
+void SeedRandom(uint32_t seed) {
+    rand_gen.seed(seed);
+}
 
 State Problem::RandomState() {
-    rand_gen.seed(rand_dev());
     State ans(this);
+    Randomize(ans);
+    return ans;
+}
+
+void Problem::Randomize(State& s) {
+    // Starts over from the givens, since `s` may be left over from another
+    // puzzle (e.g. the genetic population is kept across `Init`)
+    s.problem = this;
+    s.data.resize(fixed.size());
     for (size_t i = 0; i < fixed.size(); ++i) {
-        if (!IsFixed(i)) {
-            ans.data[i] = cell_value_dist(rand_gen);
+        s.data[i] = IsFixed(i) ? fixed[i] : cell_value_dist(rand_gen);
+    }
+    s.Rehash();
+    s.eval.reset();
+}
+
+void Problem::FillBlanks(State& s) {
+    for (size_t i = 0; i < s.data.size(); ++i) {
+        if (!IsFixed(i) && s.data[i] == 0) {
+            s.Set(i, cell_value_dist(rand_gen));
         }
     }
-    return ans;
+}
+
+bool Problem::Fits(const State& s) {
+    if (s.problem != this || s.data.size() != fixed.size()) return false;
+    for (size_t i = 0; i < fixed.size(); ++i) {
+        if (IsFixed(i) && s.data[i] != fixed[i]) return false;
+    }
+    return true;
+}
+
+State Problem::WarmStart(Checkpoint& checkpoint) {
+    for (auto& s : checkpoint.population) {
+        if (Fits(s)) {
+            State ans = s;
+            FillBlanks(ans);
+            return ans;
+        }
+    }
+    if (Fits(checkpoint.best)) {
+        State ans = checkpoint.best;
+        FillBlanks(ans);
+        return ans;
+    }
+    return RandomState();
 }
 
 int State::CountConflicts() {
     if (eval) return *eval;
 
-    std::unordered_set<int> h;
+    // Values seen so far in the current row, column or box, as bits
+    uint64_t seen = 0;
     size_t n = problem->n;
     int ans = 0;
 
     for (size_t row = 0; row < n; ++row) {
         for (size_t col = 0; col < n; ++col) {
-            int x = data[Index(row, col, n)];
-            if (h.count(x) > 0) ans++;
-            h.insert(x);
+            uint64_t bit = 1ull << data[Index(row, col, n)];
+            ans += (seen & bit) != 0;
+            seen |= bit;
         }
-        h.clear();
+        seen = 0;
     }
 
     for (size_t col = 0; col < n; ++col) {
         for (size_t row = 0; row < n; ++row) {
-            int x = data[Index(row, col, n)];
-            if (h.count(x) > 0) ans++;
-            h.insert(x);
+            uint64_t bit = 1ull << data[Index(row, col, n)];
+            ans += (seen & bit) != 0;
+            seen |= bit;
         }
-        h.clear();
+        seen = 0;
     }
 
     size_t m = (int)sqrt(n);
@@ -141,15 +397,15 @@ int State::CountConflicts() {
             for (size_t sq_col = 0; sq_col < m; ++sq_col) {
                 int row = row_start + sq_row;
                 int col = col_start + sq_col;
-                int x = data[Index(row, col, n)];
-                if (h.count(x) > 0) ans++;
-                h.insert(x);
+                uint64_t bit = 1ull << data[Index(row, col, n)];
+                ans += (seen & bit) != 0;
+                seen |= bit;
             }
         }
-        h.clear();
+        seen = 0;
     }
 
-    *eval = ans;
+    eval = ans;
     return ans;
 }
 
@@ -162,78 +418,203 @@ bool State::IsGoal() {
 }
 
 State Problem::HillClimber(State state) {
-    state = this->RandomState();
-    int i = 0;
+    Checkpoint checkpoint;
+    checkpoint.population.push_back(state);
+    return HillClimber(checkpoint).best;
+}
+
+Checkpoint Problem::HillClimber(Checkpoint checkpoint, size_t max_iters) {
+    SolverStats stats;
+    PhaseTimer total_timer(stats.total_time);
+    BudgetCheck check(budget);
+    size_t evals = 0;
+    State state = WarmStart(checkpoint);
+    State best = state;
+    if (Fits(checkpoint.best)) {
+        if (checkpoint.best.Eval() < best.Eval()) best = checkpoint.best;
+    }
+
+    std::unique_ptr<HashIndex> visited;
+    if (hill_options.visited_capacity > 0) {
+        visited.reset(new HashIndex(hill_options.visited_capacity));
+    }
+
+    size_t i = checkpoint.iter;
+    size_t end = checkpoint.iter + max_iters;
+    size_t restarts = checkpoint.restarts;
+    // Reused by every iteration, so steps don't allocate
+    State succ(this);
+    State best_succ(this);
+
     while (true) {
-        for (int x : state.data) {
-            std::cout << x << " ";
+        if (progress && progress->Sample(i)) {
+            ProgressEvent event;
+            event.engine = ProgressEvent::Engine::HillClimber;
+            event.iter = i;
+            event.state = &state;
+            event.eval = state.Eval();
+            progress->Report(event);
         }
-        std::cout <<
-            std::right << std::setw(3) << state.Eval() << " / "
-            << i << std::endl;
 
-        auto iter = StateIter(&state);
-
-        State best_succ(this);
-        best_succ.eval = INT_MAX; // TODO: hacky
+        if (state.Eval() < best.Eval()) {
+            best = state;
+        }
 
-        while (true) {
-            auto succ_opt = iter.Successor();
-            if (!succ_opt) break;
-            auto succ = *succ_opt;
-            if (succ.Eval() < best_succ.Eval()) {
-                best_succ = succ;
-            }
+        if (state.IsGoal() || (max_iters > 0 && i >= end)) {
+            break;
         }
+        if (check.Exhausted(evals)) break;
 
-        if (state.IsGoal()) {
-            return state;
+        Tally(stats.iterations);
+        auto iter = StateIter(&state);
+        bool has_succ = false;
+
+        {
+            PhaseTimer timer(stats.successor_time);
+            // Also checked per successor, since a neighbourhood of a big
+            // board takes a while
+            while (!check.Exhausted(evals) && iter.Successor(succ)) {
+                evals++;
+                Tally(stats.successors);
+                Tally(stats.evals);
+                if (!has_succ || succ.Eval() < best_succ.Eval()) {
+                    best_succ = succ;
+                    has_succ = true;
+                }
+            }
         }
+        if (check.stop != BudgetStop::None) break;
 
-        if (best_succ.Eval() < state.Eval()) {
+        if (has_succ && best_succ.Eval() < state.Eval()) {
             state = best_succ;
         } else {
             // Local min, restart at a random state
-            state = this->RandomState();
+            Randomize(state);
+            restarts++;
+            evals++;
+            Tally(stats.restarts);
+            Tally(stats.evals);
+        }
+
+        if (visited) {
+            int unused;
+            if (visited->Find(state.hash, unused)) {
+                // An earlier climb passed through this state. Climbing is
+                // deterministic from here and that climb ended in a local
+                // min, so restart instead of repeating it.
+                Randomize(state);
+                restarts++;
+                evals++;
+                Tally(stats.restarts);
+                Tally(stats.evals);
+                Tally(stats.cache_hits);
+            } else {
+                if (visited->Size() > visited->Capacity() / 2) {
+                    visited->Clear();
+                }
+                visited->Insert(state.hash, 0);
+            }
         }
 
         i++;
     }
 
-    return state;
+    if (progress && progress->Enabled()) {
+        ProgressEvent event;
+        event.engine = ProgressEvent::Engine::HillClimber;
+        event.done = true;
+        event.iter = i;
+        event.state = &best;
+        event.eval = best.Eval();
+        if (visited) {
+            event.visited_hits = visited->hits;
+            event.visited_lookups = visited->lookups;
+        }
+        progress->Report(event);
+    }
+
+    checkpoint.is_goal = best.IsGoal();
+    checkpoint.best = best;
+    checkpoint.population = std::vector<State>(1, state);
+    checkpoint.iter = i;
+    checkpoint.restarts = restarts;
+    checkpoint.stopped = check.stop;
+    total_timer.Stop();
+    checkpoint.stats += stats;
+    return checkpoint;
 }
 
 State Problem::OnePointCrossover(State p1, State p2) {
-    rand_gen.seed(rand_dev());
+    State child;
+    OnePointCrossover(p1, p2, child);
+    return child;
+}
+
+State Problem::NPointCrossover(State p1, State p2) {
+    State child;
+    NPointCrossover(p1, p2, child);
+    return child;
+}
+
+State Problem::UniformCrossover(State p1, State p2) {
+    State child;
+    UniformCrossover(p1, p2, child);
+    return child;
+}
+
+State Problem::Reproduce(State p1, State p2, CrossoverType type) {
+    State child;
+    Reproduce(p1, p2, type, child);
+    return child;
+}
+
+void Problem::OnePointCrossover(
+    const State& p1,
+    const State& p2,
+    State& child
+) {
     auto crossover_dist = std::uniform_int_distribution<size_t>(
         0, p1.data.size() - 1
     );
-    auto crossover_rand = std::bind(crossover_dist, rand_gen);
-    size_t crossover_point = crossover_rand();
+    size_t crossover_point = crossover_dist(rand_gen);
 
-    State child = p1;
+    child = p1;
     for (size_t i = crossover_point; i < p2.data.size(); ++i) {
-        child.data[i] = p2.data[i];
+        child.Set(i, p2.data[i]);
     }
-
-    return child;
 }
 
-State Problem::NPointCrossover(State p1, State p2) {
-    std::vector<size_t> crossover_rand(p1.data.size());
-    for (size_t i = 0; i < crossover_rand.size(); ++i) {
-        crossover_rand[i] = i;
+void Problem::NPointCrossover(
+    const State& p1,
+    const State& p2,
+    State& child
+) {
+    // Per thread and kept between calls. Any permutation of the cells is a
+    // fine start for a partial shuffle, so it isn't reset.
+    thread_local std::vector<size_t> crossover_rand;
+    thread_local std::vector<size_t> crossovers;
+    if (crossover_rand.size() != p1.data.size()) {
+        crossover_rand.resize(p1.data.size());
+        for (size_t i = 0; i < crossover_rand.size(); ++i) {
+            crossover_rand[i] = i;
+        }
     }
-    std::random_shuffle(crossover_rand.begin(), crossover_rand.end());
 
-    size_t n_crossovers = p1.problem->n;
-    std::vector<size_t> crossovers(
+    // The first `n_crossovers` of a shuffle, without shuffling the rest
+    size_t n_crossovers = std::min(p1.problem->n, crossover_rand.size());
+    for (size_t i = 0; i < n_crossovers; ++i) {
+        std::uniform_int_distribution<size_t> pick_dist(
+            i, crossover_rand.size() - 1
+        );
+        std::swap(crossover_rand[i], crossover_rand[pick_dist(rand_gen)]);
+    }
+    crossovers.assign(
         crossover_rand.begin(),
         crossover_rand.begin() + n_crossovers
     );
     std::sort(crossovers.begin(), crossovers.end());
 
-    State child = p1;
+    child = p1;
 
     for (size_t i = 1; i < crossovers.size(); i += 2) {
         size_t start = crossovers[i]; // Inclusive
@@ -246,48 +627,53 @@ State Problem::NPointCrossover(State p1, State p2) {
         }
 
         for (size_t j = start; j < end; ++j) {
-            child.data[i] = p2.data[i];
+            child.Set(j, p2.data[j]);
         }
     }
-
-    return child;
 }
 
-State Problem::UniformCrossover(State p1, State p2) {
-    rand_gen.seed(rand_dev());
+void Problem::UniformCrossover(
+    const State& p1,
+    const State& p2,
+    State& child
+) {
     std::uniform_int_distribution<int> uniform_dist(0, 1);
-    auto uniform_rand = std::bind(uniform_dist, rand_gen);
+    auto uniform_rand = std::bind(uniform_dist, std::ref(rand_gen));
 
-    State child = p1;
+    child = p1;
     for (size_t i = 0; i < child.data.size(); ++i) {
         if (uniform_rand()) {
-            child.data[i] = p2.data[i];
+            child.Set(i, p2.data[i]);
         }
     }
-
-    return child;
 }
 
-State Problem::Reproduce(State p1, State p2, CrossoverType type) {
+void Problem::Reproduce(
+    const State& p1,
+    const State& p2,
+    CrossoverType type,
+    State& child
+) {
     switch (type) {
         case CrossoverType::OnePoint:
-            return OnePointCrossover(p1, p2);
+            OnePointCrossover(p1, p2, child);
+            break;
         case CrossoverType::NPoint:
-            return NPointCrossover(p1, p2);
+            NPointCrossover(p1, p2, child);
+            break;
         case CrossoverType::Uniform:
-            return UniformCrossover(p1, p2);
+            UniformCrossover(p1, p2, child);
+            break;
         default:
             throw std::invalid_argument("Invalid crossover type");
     }
 }
 
 void Problem::Mutate(State& s) {
-    rand_gen.seed(rand_dev());
-
     auto mutation_dist = std::uniform_int_distribution<size_t>(
         0, s.data.size() - 1
     );
-    auto mutation_rand = std::bind(mutation_dist, rand_gen);
+    auto mutation_rand = std::bind(mutation_dist, std::ref(rand_gen));
 
     size_t point1 = mutation_rand();
     while (IsFixed(point1)) {
@@ -299,42 +685,167 @@ void Problem::Mutate(State& s) {
         point2 = mutation_rand();
     }
 
-    std::swap(s.data[point1], s.data[point2]);
+    int value1 = s.data[point1];
+    s.Set(point1, s.data[point2]);
+    s.Set(point2, value1);
 }
 
 void Problem::ReproduceChunk(
     std::vector<State>& population,
     std::vector<State>& children,
-    std::discrete_distribution<int>& parent_dist,
+    const std::vector<uint64_t>& parent_cumulative,
     size_t start, size_t end,
     double mutate_prob,
-    CrossoverType type
+    CrossoverType type,
+    HashIndex* index,
+    uint32_t seed,
+    SolverStats& stats
 ) {
-    rand_gen.seed(rand_dev());
+    // Seeded by the caller, so runs repeat after `SeedRandom` even though
+    // each generation runs on whichever worker thread
+    rand_gen.seed(seed);
 
     std::uniform_real_distribution<double> mutation_dist(0.0, 1.0);
-    auto mutation_rand = std::bind(mutation_dist, rand_gen);
-    auto parent_rand = std::bind(parent_dist, rand_gen);
+    auto mutation_rand = std::bind(mutation_dist, std::ref(rand_gen));
+
+    // Roulette wheel over the running sums; uniform if every weight is 0
+    uint64_t total = parent_cumulative.back();
+    std::uniform_int_distribution<uint64_t> parent_dist(
+        0, total > 0 ? total - 1 : population.size() - 1
+    );
+    auto parent_rand = [&] () -> State& {
+        uint64_t r = parent_dist(rand_gen);
+        if (total == 0) return population[r];
+        return population[
+            std::upper_bound(
+                parent_cumulative.begin(), parent_cumulative.end(), r
+            ) - parent_cumulative.begin()
+        ];
+    };
 
     for (size_t i = start; i < end; ++i) {
-        State parent1 = population[parent_rand()];
-        State parent2 = population[parent_rand()];
-        State child = Reproduce(parent1, parent2, type);
+        State& parent1 = parent_rand();
+        State& parent2 = parent_rand();
+        State& child = children[i];
+        Reproduce(parent1, parent2, type, child);
+        Tally(stats.crossovers);
         if (mutation_rand() < mutate_prob) {
             Mutate(child);
+            Tally(stats.mutations);
+        }
+        if (index) {
+            // Re-mutate children that already exist in this generation
+            for (
+                size_t attempt = 0;
+                !index->Insert(child.hash) &&
+                    attempt < genetic_options.max_remutations;
+                ++attempt
+            ) {
+                Mutate(child);
+                Tally(stats.mutations);
+            }
+        }
+    }
+}
+
+double Problem::Diversity(std::vector<State>& population, size_t samples) {
+    // Mean Hamming distance between randomly sampled pairs, normalised by the
+    // number of blank cells (fixed cells never differ)
+    if (population.size() < 2 || NBlanks() == 0 || samples == 0) return 0;
+
+    auto member_dist = std::uniform_int_distribution<size_t>(
+        0, population.size() - 1
+    );
+    auto offset_dist = std::uniform_int_distribution<size_t>(
+        1, population.size() - 1
+    );
+
+    size_t distance = 0;
+    for (size_t sample = 0; sample < samples; ++sample) {
+        size_t a = member_dist(rand_gen);
+        size_t b = (a + offset_dist(rand_gen)) % population.size();
+        auto& data_a = population[a].data;
+        auto& data_b = population[b].data;
+        for (size_t i = 0; i < data_a.size(); ++i) {
+            distance += data_a[i] != data_b[i];
         }
-        children[i] = child;
     }
+
+    return (double)distance / (samples * NBlanks());
 }
 
-void Problem::EvalGeneticChunk(
+void Problem::Reseed(std::vector<State>& population, double fraction) {
+    // Selection sampling, so exactly `count` distinct members are replaced
+    size_t count = fraction * population.size();
+    for (size_t i = 0; i < population.size() && count > 0; ++i) {
+        auto dist = std::uniform_int_distribution<size_t>(
+            0, population.size() - i - 1
+        );
+        if (dist(rand_gen) < count) {
+            Randomize(population[i]);
+            count--;
+        }
+    }
+}
+
+size_t Problem::EvalGeneticChunk(
     std::vector<State>& population,
     std::vector<int>& parent_probs,
-    size_t start, size_t end
+    HashIndex* memo,
+    size_t start, size_t end,
+    SolverStats& stats
 ) {
+    size_t hits = 0;
     for (size_t i = start; i < end; ++i) {
-        parent_probs[i] = EvalGenetic(population[i]);
+        State& s = population[i];
+        int eval;
+        if (memo && !s.eval && memo->Find(s.hash, eval)) {
+            s.eval = eval;
+            Tally(stats.cache_hits);
+            hits++;
+        }
+        if (!s.eval) Tally(stats.evals);
+        parent_probs[i] = EvalGenetic(s);
+        if (memo) memo->Insert(s.hash, s.Eval());
     }
+    return hits;
+}
+
+void Problem::ReportGenetic(
+    State& best_state,
+    size_t iter,
+    size_t streak,
+    double diversity,
+    double mutate_rate,
+    size_t restarts,
+    bool done
+) {
+    if (!progress || !progress->Enabled()) return;
+    ProgressEvent event;
+    event.engine = ProgressEvent::Engine::Genetic;
+    event.done = done;
+    event.iter = iter;
+    event.state = &best_state;
+    event.eval = EvalGenetic(best_state);
+    event.goal_eval = GoalEvalGenetic();
+    event.streak = streak;
+    event.diversity = diversity;
+    event.mutate_rate = mutate_rate;
+    event.restarts = restarts;
+    progress->Report(event);
+}
+
+void Problem::TraceGenetic(
+    GenerationTrace& record,
+    const std::vector<double>& thread_busy
+) {
+    if (!trace) return;
+    double busy = 0;
+    for (double b : thread_busy) busy += b;
+    double available =
+        thread_busy.size() * (record.eval_time + record.reproduce_time);
+    record.utilisation = available > 0 ? std::min(busy / available, 1.0) : 0;
+    trace->Record(record);
 }
 
 std::tuple<bool, State> Problem::Genetic(
@@ -345,141 +856,287 @@ std::tuple<bool, State> Problem::Genetic(
     CrossoverType type,
     size_t n_threads
 ) {
-    std::vector<State> population(size);
-    std::vector<State> children(size);
-    std::vector<int> parent_probs(size);
+    Checkpoint checkpoint = Genetic(
+        Checkpoint(),
+        size,
+        mutate_prob,
+        terminate_streak,
+        terminate_epsilon,
+        type,
+        n_threads
+    );
+    return std::tuple<bool, State>(checkpoint.is_goal, checkpoint.best);
+}
+
+Checkpoint Problem::Genetic(
+    Checkpoint checkpoint,
+    size_t size,
+    double mutate_prob,
+    size_t terminate_streak,
+    double terminate_epsilon,
+    CrossoverType type,
+    size_t n_threads
+) {
+    SolverStats stats;
+    PhaseTimer total_timer(stats.total_time);
+    BudgetCheck check(budget);
+    size_t evals = 0;
+    // One per thread, added to `stats` at the end
+    std::vector<SolverStats> thread_stats(n_threads);
+    // Busy seconds and memo hits per thread, only kept for `trace`
+    std::vector<double> thread_busy(n_threads);
+    std::vector<size_t> thread_hits(n_threads);
+    GenerationTrace record;
+
+    // Kept in the problem so that batch runs reuse them between puzzles
+    std::vector<State>& population = genetic_population;
+    std::vector<State>& children = genetic_children;
+    std::vector<int>& parent_probs = genetic_parent_probs;
+    population.resize(size);
+    children.resize(size);
+    parent_probs.resize(size);
+
+    std::unique_ptr<HashIndex> index;
+    std::unique_ptr<HashIndex> memo;
+    if (genetic_options.hash_index) {
+        index.reset(new HashIndex(2 * size));
+        memo.reset(new HashIndex(8 * size));
+    }
 
+    // Seed from the checkpoint's population and best state, then fill up
+    // with random states. States of a puzzle loaded before are skipped.
+    std::vector<State> seeds;
+    for (auto& s : checkpoint.population) {
+        if (Fits(s)) seeds.push_back(s);
+    }
+    if (Fits(checkpoint.best)) {
+        seeds.push_back(checkpoint.best);
+    }
     for (size_t i = 0; i < size; ++i) {
-        population[i] = RandomState();
+        if (i < seeds.size()) {
+            population[i] = seeds[i];
+            FillBlanks(population[i]);
+        } else {
+            Randomize(population[i]);
+        }
     }
 
     State best_state_all;
     best_state_all.eval = INT_MIN;
 
-    int prev_eval;
+    // Unset until the first generation is evaluated
+    bool has_prev_eval = false;
+    int prev_eval = 0;
 
     size_t streak = 0;
-    size_t iter = 0;
+    size_t iter = checkpoint.iter;
+    size_t restarts = checkpoint.restarts;
+    double mutate_rate = mutate_prob;
+
+    // Workers and their jobs last the whole run, so that once the buffers
+    // have grown a generation doesn't allocate
+    WorkerPool workers(n_threads);
+    size_t thread_size = size / n_threads;
+    auto chunk_end = [&] (size_t t) {
+        return t == n_threads - 1 ? size : (t + 1) * thread_size;
+    };
+    std::vector<uint64_t> parent_cumulative(size);
+    std::vector<uint32_t> thread_seeds(n_threads);
+
+    std::function<void(size_t)> eval_job = [&] (size_t t) {
+        PerfTimer perf(thread_stats[t].eval_time.perf);
+        TraceClock::time_point busy_start;
+        if (trace) busy_start = TraceClock::now();
+        thread_hits[t] = EvalGeneticChunk(
+            population,
+            parent_probs,
+            memo.get(),
+            t * thread_size, chunk_end(t),
+            thread_stats[t]
+        );
+        if (trace) thread_busy[t] += Since(busy_start);
+    };
+    std::function<void(size_t)> reproduce_job = [&] (size_t t) {
+        PerfTimer perf(thread_stats[t].reproduce_time.perf);
+        TraceClock::time_point busy_start;
+        if (trace) busy_start = TraceClock::now();
+        ReproduceChunk(
+            population,
+            children,
+            parent_cumulative,
+            t * thread_size, chunk_end(t),
+            mutate_rate,
+            type,
+            index.get(),
+            thread_seeds[t],
+            thread_stats[t]
+        );
+        if (trace) thread_busy[t] += Since(busy_start);
+    };
 
     while (true) {
-        State best_state;
-        best_state.eval = INT_MIN;
-
-        size_t thread_size = size / n_threads;
+        Tally(stats.generations);
+        if (trace) {
+            record = GenerationTrace();
+            record.iter = iter;
+            record.restarts = restarts;
+            record.mutate_rate = mutate_rate;
+            std::fill(thread_busy.begin(), thread_busy.end(), 0);
+        }
+        // The clock is only read when tracing
+        TraceClock::time_point phase_start;
+        if (trace) phase_start = TraceClock::now();
 
         {
-            std::vector<std::thread> threads;
-
-            for (size_t thread_i = 0; thread_i < n_threads; ++thread_i) {
-                size_t start = thread_i * thread_size; // Inclusive
-                size_t end; // Exclusive
-                if (thread_i == n_threads - 1) {
-                    end = size;
-                } else {
-                    end = (thread_i + 1) * thread_size;
-                }
+            PhaseTimer timer(stats.eval_time);
+            workers.Run(eval_job);
+        }
+        evals += size;
 
-                threads.push_back(
-                    std::thread(
-                        [
-                        this,
-                        &population,
-                        &parent_probs,
-                        start, end
-                        ] () mutable {
-                            this->EvalGeneticChunk(
-                                population,
-                                parent_probs,
-                                start, end
-                            );
-                        }
-                    )
-                );
+        size_t best_i = 0;
+        for (size_t i = 1; i < population.size(); ++i) {
+            if (EvalGenetic(population[i]) > EvalGenetic(population[best_i])) {
+                best_i = i;
             }
-
-            for (auto& t : threads) t.join();
         }
-
-        for (size_t i = 0; i < population.size(); ++i) {
-            if (EvalGenetic(population[i]) > EvalGenetic(best_state)) {
-                best_state = population[i];
+        State& best_state = population[best_i];
+        if (trace) {
+            record.eval_time = Since(phase_start);
+            record.best = EvalGenetic(best_state);
+            record.worst = record.best;
+            for (auto& s : population) {
+                int64_t eval = EvalGenetic(s);
+                record.worst = std::min(record.worst, eval);
+                record.mean += eval;
             }
+            record.mean /= size;
+            size_t hits = 0;
+            for (size_t h : thread_hits) hits += h;
+            record.cache_hit_ratio = (double)hits / size;
         }
 
-        if (abs(prev_eval - EvalGenetic(best_state)) <= terminate_epsilon) {
+        if (
+            has_prev_eval &&
+            abs(prev_eval - EvalGenetic(best_state)) <= terminate_epsilon
+        ) {
             streak++;
         } else {
             streak = 0;
         }
         prev_eval = EvalGenetic(best_state);
+        has_prev_eval = true;
 
         if (EvalGenetic(best_state) == GoalEvalGenetic()) {
-            return std::tuple<bool, State>(true, best_state);
+            ReportGenetic(
+                best_state, iter, streak, 0, mutate_rate, restarts, true
+            );
+            TraceGenetic(record, thread_busy);
+            checkpoint.is_goal = true;
+            best_state_all = best_state;
+            break;
         }
 
-        for (int x : best_state.data) {
-            std::cout << x << " ";
+        double diversity = Diversity(
+            population, genetic_options.diversity_samples
+        );
+        record.diversity = diversity;
+        if (diversity < genetic_options.diversity_low) {
+            // Never capped below the base rate
+            mutate_rate = std::min(
+                mutate_rate * genetic_options.mutate_boost,
+                std::max(mutate_prob, genetic_options.mutate_max)
+            );
+        } else {
+            mutate_rate = std::max(
+                mutate_rate / genetic_options.mutate_boost,
+                mutate_prob
+            );
         }
 
-        std::cout <<
-            std::right << std::setw(3) <<
-            EvalGenetic(best_state) << " / " <<
-            GoalEvalGenetic() << " / " <<
-            streak << " / " <<
-            iter << std::endl;
-
-        if (streak >= terminate_streak) {
-            return std::tuple<bool, State>(false, best_state_all);
+        if (progress && progress->Sample(iter)) {
+            ReportGenetic(
+                best_state, iter, streak, diversity, mutate_rate, restarts,
+                false
+            );
         }
+        record.mutate_rate = mutate_rate;
 
         if (EvalGenetic(best_state) > EvalGenetic(best_state_all)) {
             best_state_all = best_state;
         }
 
-        std::discrete_distribution<int> parent_dist(
-            std::begin(parent_probs), std::end(parent_probs)
-        );
-
-        {
-            std::vector<std::thread> threads;
-
-            for (size_t thread_i = 0; thread_i < n_threads; ++thread_i) {
-                size_t start = thread_i * thread_size; // Inclusive
-                size_t end; // Exclusive
-                if (thread_i == n_threads - 1) {
-                    end = size;
-                } else {
-                    end = (thread_i + 1) * thread_size;
-                }
+        if (check.Exhausted(evals)) {
+            ReportGenetic(
+                best_state_all, iter, streak, diversity, mutate_rate,
+                restarts, true
+            );
+            TraceGenetic(record, thread_busy);
+            checkpoint.is_goal = false;
+            break;
+        }
 
-                threads.push_back(
-                    std::thread(
-                        [
-                            this,
-                            &population,
-                            &children,
-                            &parent_dist,
-                            start, end,
-                            mutate_prob,
-                            type
-                        ] () mutable {
-                            this->ReproduceChunk(
-                                population,
-                                children,
-                                parent_dist,
-                                start, end,
-                                mutate_prob,
-                                type
-                            );
-                        }
-                    )
+        bool reseed = false;
+        if (streak >= terminate_streak) {
+            if (
+                restarts - checkpoint.restarts >=
+                genetic_options.max_restarts
+            ) {
+                ReportGenetic(
+                    best_state_all, iter, streak, diversity, mutate_rate,
+                    restarts, true
                 );
+                TraceGenetic(record, thread_busy);
+                checkpoint.is_goal = false;
+                break;
             }
+            reseed = true;
+            restarts++;
+            Tally(stats.restarts);
+            streak = 0;
+        }
 
-            for (auto& t : threads) t.join();
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < size; ++i) {
+            cumulative += parent_probs[i];
+            parent_cumulative[i] = cumulative;
         }
+        for (auto& seed : thread_seeds) seed = rand_gen();
 
-        population = children;
+        if (index) {
+            index->Clear();
+            if (memo->Size() > memo->Capacity() / 2) memo->Clear();
+        }
+
+        if (trace) phase_start = TraceClock::now();
+        {
+            PhaseTimer timer(stats.reproduce_time);
+            workers.Run(reproduce_job);
+        }
+        if (trace) record.reproduce_time = Since(phase_start);
+
+        population.swap(children);
+
+        if (reseed) {
+            // Partial restart: keep the best state found so far and replace
+            // part of the population with fresh random states
+            Reseed(population, genetic_options.reseed_fraction);
+            population[0] = best_state_all;
+        }
+
+        TraceGenetic(record, thread_busy);
         iter++;
     }
+
+    // Best state first, so that handing this checkpoint to another solver
+    // starts from it
+    checkpoint.best = best_state_all;
+    checkpoint.population = population;
+    checkpoint.population.insert(checkpoint.population.begin(), best_state_all);
+    checkpoint.iter = iter;
+    checkpoint.restarts = restarts;
+    checkpoint.stopped = check.stop;
+    for (auto& t : thread_stats) stats += t;
+    total_timer.Stop();
+    checkpoint.stats += stats;
+    return checkpoint;
 }
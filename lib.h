@@ -4,15 +4,31 @@
 #include <random>
 #include <unordered_set>
 #include <tuple>
+#include <atomic>
+#include <memory>
+#include <cstdint>
 #include "optional.hpp"
+#include "progress.h"
+#include "parse.h"
+#include "stats.h"
+#include "budget.h"
+
+class GeneticTrace;
+struct GenerationTrace;
 
 size_t Index(size_t row, size_t col, size_t n);
 void PrintBoard(std::vector<int> board, size_t n);
 
+// Seeds the calling thread's generator, which the solvers draw from (genetic
+// worker threads are seeded from it too). Without it the seed comes from
+// `std::random_device`. The same seed, puzzle and options repeat a run,
+// except with the genetic hash index and more than one thread.
+void SeedRandom(uint32_t seed);
+
 class Problem;
 
 struct State {
-    Problem* problem;
+    Problem* problem = nullptr;
     std::vector<int> data;
     State() { };
     State(Problem* problem);
@@ -25,12 +41,36 @@ struct State {
 
     void Print();
 
+    // Zobrist hash of `data`, kept up to date by `Set`
+    uint64_t hash = 0;
+    void Set(size_t i, int value);
+    void Rehash();
+
     int CountConflicts();
     int Eval();
     tl::optional<int> eval; // Cached value
     bool IsGoal();
 };
 
+// Resumable solver result. Passing it back to the same solver continues the
+// run; passing it to a different one hands the run over.
+struct Checkpoint {
+    bool is_goal = false;
+    State best;
+    // Genetic population (best state first), or the hill climber's current
+    // state
+    std::vector<State> population;
+    size_t iter = 0;
+    size_t restarts = 0;
+    SolverStats stats;
+    // Set when the last run ran out of `Problem::budget`
+    BudgetStop stopped = BudgetStop::None;
+
+    Checkpoint() { };
+    Checkpoint(Problem* problem, std::string filename);
+    void Save(std::string filename);
+};
+
 // https://stackoverflow.com/a/29855973/6759699
 namespace std {
     template<>
@@ -58,14 +98,37 @@ namespace std {
     template<>
     struct hash<State> {
         size_t operator()(const State& state) const noexcept {
-            size_t ans = 0;
-            hash_combine(ans, state.problem);
-            hash_combine(ans, state.data);
-            return ans;
+            return state.hash;
         }
     };
 }
 
+// Fixed-capacity open-addressing table from Zobrist hashes to evals.
+// Insertion and lookup are lock-free so that worker threads can share one
+// index. Boards are identified by their 64-bit hash alone.
+class HashIndex {
+private:
+    size_t mask;
+    std::unique_ptr<std::atomic<uint64_t>[]> keys;
+    std::unique_ptr<std::atomic<int>[]> values;
+    std::atomic<size_t> count;
+    static const size_t max_probes = 16;
+    static const int pending = -1;
+public:
+    std::atomic<size_t> lookups;
+    std::atomic<size_t> hits;
+
+    HashIndex(size_t capacity);
+
+    // Returns false if `key` is already present
+    bool Insert(uint64_t key, int value = pending);
+    bool Find(uint64_t key, int& value);
+    void Clear();
+
+    inline size_t Size() { return count; }
+    inline size_t Capacity() { return mask + 1; }
+};
+
 class StateIter {
 private:
     State* state;
@@ -75,24 +138,105 @@ private:
 public:
     StateIter(State* state);
     tl::optional<State> Successor();
+    // Writes the next successor into `succ`, reusing its storage. Returns
+    // false after the last one.
+    bool Successor(State& succ);
+};
+
+struct HillClimberOptions {
+    // Capacity of the visited set, which remembers states from earlier
+    // climbs so they are not climbed again after a restart. 0 disables it.
+    // The set is cleared when it gets half full.
+    size_t visited_capacity = 0;
+};
+
+// Tunables for the adaptive parts of `Problem::Genetic`
+struct GeneticOptions {
+    // Diversity is estimated from this many random pairs each generation, so
+    // the cost is independent of the population size
+    size_t diversity_samples = 32;
+
+    // When diversity falls below `diversity_low`, the mutation rate is scaled
+    // by `mutate_boost` every generation, up to `mutate_max` (or the base
+    // `mutate_prob` if that is higher). Once diversity recovers it decays
+    // back towards the base `mutate_prob`.
+    double diversity_low = 0.1;
+    double mutate_boost = 1.5;
+    double mutate_max = 0.5;
+
+    // On stagnation, replace this fraction of the population with random
+    // states instead of terminating. Give up after `max_restarts` reseeds
+    // in one call.
+    double reseed_fraction = 0.5;
+    size_t max_restarts = 8;
+
+    // Index each generation by Zobrist hash: duplicate children are
+    // re-mutated (up to `max_remutations` times) and evals are memoised
+    // across generations
+    bool hash_index = false;
+    size_t max_remutations = 4;
 };
 
 class Problem {
 private:
     std::uniform_int_distribution<int> cell_value_dist;
+    std::vector<State> genetic_population;
+    std::vector<State> genetic_children;
+    std::vector<int> genetic_parent_probs;
+    std::vector<int> load_cells;
 public:
     size_t n;
     std::vector<int> fixed;
     size_t n_fixed;
+    std::vector<uint64_t> zobrist;
+    HillClimberOptions hill_options;
+    GeneticOptions genetic_options;
+
+    // Where solvers report progress. Solvers never print directly; nullptr
+    // is silent.
+    Progress* progress;
+    // Receives a record per generation of `Genetic` (see `trace.h`);
+    // nullptr for none
+    GeneticTrace* trace;
+    // Limits every solver run on this problem
+    Budget budget;
+    Problem();
     Problem(std::string filename);
+    // Loads a board. Can be called again to reuse the problem for another
+    // puzzle.
+    void Init(size_t n, const std::vector<int>& cells);
+
+    // Load a board without touching the filesystem: text in any format
+    // accepted by `TryParseBoard` (e.g. an 81-character line), or `n * n`
+    // raw cells with 0 for blanks. On error the status is returned and the
+    // problem is left as it was; nothing is thrown.
+    ParseStatus Load(const char* begin, const char* end);
+    ParseStatus Load(const std::string& text);
+    ParseStatus Load(size_t n, const int* cells);
 
     void Print() { PrintBoard(fixed, n); }
+    inline uint64_t Zobrist(size_t i, int value) {
+        return zobrist[(i * (n + 1)) + value];
+    }
     inline bool IsFixed(size_t i) { return fixed[i] != 0; }
     inline size_t NBlanks() { return (n * n) - n_fixed; }
     inline size_t MaxConflicts() { return NBlanks() * 3; }
 
     State RandomState();
+    // Like `RandomState`, but reuses the state's storage
+    void Randomize(State& s);
+    void FillBlanks(State& s);
+    // Whether `s` is a board of the puzzle loaded now. A checkpoint's states
+    // keep pointing at the problem after another puzzle is loaded into it.
+    bool Fits(const State& s);
+    State WarmStart(Checkpoint& checkpoint);
+
+    // Starts from `state`. Blank (0) cells are filled in randomly.
     State HillClimber(State state);
+    // Continues from the checkpoint's current or best state. Stops at the
+    // goal, after `max_iters` iterations (0 for no limit), or when `budget`
+    // runs out.
+    Checkpoint HillClimber(Checkpoint checkpoint, size_t max_iters = 0);
 
     void Mutate(State& s);
 
@@ -105,24 +249,62 @@ public:
     State NPointCrossover(State p1, State p2);
     State UniformCrossover(State p1, State p2);
     State Reproduce(State p1, State p2, CrossoverType type);
+    // Write the child into `child`, reusing its storage. `child` can't be
+    // `p2`.
+    void OnePointCrossover(const State& p1, const State& p2, State& child);
+    void NPointCrossover(const State& p1, const State& p2, State& child);
+    void UniformCrossover(const State& p1, const State& p2, State& child);
+    void Reproduce(
+        const State& p1,
+        const State& p2,
+        CrossoverType type,
+        State& child
+    );
 
-    void EvalGeneticChunk(
+    // Returns how many evals came from `memo`
+    size_t EvalGeneticChunk(
         std::vector<State>& population,
         std::vector<int>& parent_probs,
-        size_t start, size_t end
+        HashIndex* memo,
+        size_t start, size_t end,
+        SolverStats& stats
     );
 
+    // Parents are drawn in proportion to their `EvalGenetic`, given as
+    // running sums over the population
     void ReproduceChunk(
         std::vector<State>& population,
         std::vector<State>& children,
-        std::discrete_distribution<int>& parent_dist,
+        const std::vector<uint64_t>& parent_cumulative,
         size_t start, size_t end,
         double mutate_prob,
-        CrossoverType type
+        CrossoverType type,
+        HashIndex* index,
+        uint32_t seed,
+        SolverStats& stats
+    );
+
+    double Diversity(std::vector<State>& population, size_t samples);
+    void Reseed(std::vector<State>& population, double fraction);
+
+    void ReportGenetic(
+        State& best_state,
+        size_t iter,
+        size_t streak,
+        double diversity,
+        double mutate_rate,
+        size_t restarts,
+        bool done
+    );
+    // Completes a generation's record from the threads' busy seconds and
+    // hands it to `trace`, if any
+    void TraceGenetic(
+        GenerationTrace& record,
+        const std::vector<double>& thread_busy
     );
 
     inline int GoalEvalGenetic() { return MaxConflicts(); }
-    inline int EvalGenetic(State s) { return MaxConflicts() - s.Eval(); }
+    inline int EvalGenetic(State& s) { return MaxConflicts() - s.Eval(); }
 
     std::tuple<bool, State> Genetic(
         size_t size,
@@ -132,4 +314,16 @@ public:
         CrossoverType type,
         size_t n_threads
     );
+
+    // Seeds the population from the checkpoint's population and best state
+    // and fills the rest with random states
+    Checkpoint Genetic(
+        Checkpoint checkpoint,
+        size_t size,
+        double mutate_prob,
+        size_t terminate_streak,
+        double terminate_epsilon,
+        CrossoverType type,
+        size_t n_threads
+    );
 };
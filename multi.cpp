@@ -0,0 +1,149 @@
+#include <algorithm>
+#include "multi.h"
+
+namespace {
+    // Cells of the 27 rows, columns and boxes of a 9x9 board
+    struct Units {
+        uint8_t cells[27][9];
+        Units() {
+            for (int i = 0; i < 81; ++i) {
+                int row = i / 9;
+                int col = i % 9;
+                int box = ((row / 3) * 3) + (col / 3);
+                int k = ((row % 3) * 3) + (col % 3);
+                cells[row][col] = i;
+                cells[9 + col][row] = i;
+                cells[18 + box][k] = i;
+            }
+        }
+    };
+    const Units units;
+
+    const uint16_t all_values = 0x1ff;
+
+    // All ones if `m` has at most one value, else 0. Written without
+    // branches so the lane loops vectorize.
+    inline uint16_t SingleMask(uint16_t m) {
+        return -(uint16_t)((uint16_t)(m & (m - 1)) == 0);
+    }
+}
+
+void MultiSolver::Propagate() {
+    const size_t L = multi_lanes;
+    std::fill(dead, dead + L, 0);
+
+    // Masks only ever lose values, so this ends
+    for (passes = 1; ; ++passes) {
+        uint16_t changed[L] = {};
+        for (size_t u = 0; u < 27; ++u) {
+            const uint8_t* cells = units.cells[u];
+
+            // Per lane: values seen at least once and at least twice, and
+            // values already decided (singles) in this unit
+            uint16_t once[L] = {};
+            uint16_t twice[L] = {};
+            uint16_t singles[L] = {};
+            uint16_t repeated[L] = {};
+            uint16_t empty[L] = {};
+            for (size_t k = 0; k < 9; ++k) {
+                const uint16_t* m = &masks[cells[k] * L];
+                for (size_t l = 0; l < L; ++l) {
+                    uint16_t single = m[l] & SingleMask(m[l]);
+                    twice[l] |= once[l] & m[l];
+                    once[l] |= m[l];
+                    repeated[l] |= singles[l] & single;
+                    singles[l] |= single;
+                }
+            }
+
+            for (size_t k = 0; k < 9; ++k) {
+                uint16_t* m = &masks[cells[k] * L];
+                for (size_t l = 0; l < L; ++l) {
+                    uint16_t old = m[l];
+                    // Drop values decided elsewhere in the unit, then keep
+                    // only a value that can go nowhere else
+                    uint16_t value = old & ~(singles[l] & ~SingleMask(old));
+                    uint16_t hidden = value & once[l] & ~twice[l];
+                    uint16_t has_hidden = -(uint16_t)(hidden != 0);
+                    value = (hidden & has_hidden) | (value & ~has_hidden);
+                    changed[l] |= value ^ old;
+                    empty[l] |= value == 0;
+                    m[l] = value;
+                }
+            }
+
+            // A cell with no value, a value with no place left, or a value
+            // decided twice
+            for (size_t l = 0; l < L; ++l) {
+                dead[l] |= empty[l] | (once[l] != all_values) | repeated[l];
+            }
+        }
+
+        uint16_t any = 0;
+        for (size_t l = 0; l < L; ++l) any |= dead[l] ? 0 : changed[l];
+        if (!any) break;
+    }
+}
+
+bool MultiSolver::SolveScalar(Problem& problem, std::vector<int>& solution) {
+    search.Load(problem.n, problem.fixed);
+    return search.Count(1, &solution) > 0;
+}
+
+size_t MultiSolver::Solve(
+    Problem* problems,
+    size_t count,
+    std::vector<int>* solutions,
+    std::vector<bool>& solved
+) {
+    const size_t L = multi_lanes;
+    count = std::min(count, L);
+
+    // Unused lanes and other sizes get a board that is already contradictory,
+    // so they never keep propagation going
+    bool lane_used[L] = {};
+    for (size_t l = 0; l < L; ++l) {
+        lane_used[l] = l < count && problems[l].n == 9;
+        for (size_t i = 0; i < 81; ++i) {
+            int value = lane_used[l] ? problems[l].fixed[i] : 1;
+            masks[(i * L) + l] = value ? 1 << (value - 1) : all_values;
+        }
+    }
+
+    Propagate();
+
+    size_t n_solved = 0;
+    propagated = 0;
+    for (size_t l = 0; l < count; ++l) {
+        Problem& problem = problems[l];
+        if (!lane_used[l]) {
+            solved[l] = SolveScalar(problem, solutions[l]);
+            n_solved += solved[l];
+            continue;
+        }
+        if (dead[l]) {
+            solved[l] = false;
+            continue;
+        }
+
+        // Whatever propagation decided becomes givens for the fallback
+        board.resize(81);
+        bool complete = true;
+        for (size_t i = 0; i < 81; ++i) {
+            uint16_t m = masks[(i * L) + l];
+            bool is_single = (m & (m - 1)) == 0;
+            board[i] = is_single ? __builtin_ctz(m) + 1 : 0;
+            complete &= is_single;
+        }
+        if (complete) {
+            solutions[l] = board;
+            solved[l] = true;
+            propagated++;
+        } else {
+            search.Load(9, board);
+            solved[l] = search.Count(1, &solutions[l]) > 0;
+        }
+        n_solved += solved[l];
+    }
+    return n_solved;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "lib.h"
+#include "exact.h"
+
+// 9x9 boards propagated together
+const size_t multi_lanes = 16;
+
+// Solves up to `multi_lanes` 9x9 boards at once. Candidate masks are stored
+// cell-major with one lane per board, so each propagation step is the same
+// few operations across all lanes and compiles to vector instructions.
+//
+// Propagation removes singles from their rows, columns and boxes and places
+// hidden singles, in lock-step until no lane changes. Boards it can't finish
+// (and boards of other sizes) fall back to `ExactSearch` one at a time.
+class MultiSolver {
+private:
+    // Bit `v - 1` is set if value `v` is still possible.
+    // `masks[(cell * multi_lanes) + lane]`
+    alignas(32) uint16_t masks[81 * multi_lanes];
+    // Lanes where propagation found a contradiction
+    alignas(32) uint16_t dead[multi_lanes];
+    ExactSearch search;
+    std::vector<int> board;
+
+    void Propagate();
+    bool SolveScalar(Problem& problem, std::vector<int>& solution);
+
+public:
+    // Solves `problems[0..count)`, `count` at most `multi_lanes`. Writes each
+    // solution into `solutions[k]` and whether it was found into
+    // `solved[k]`. Returns the number solved.
+    size_t Solve(
+        Problem* problems,
+        size_t count,
+        std::vector<int>* solutions,
+        std::vector<bool>& solved
+    );
+
+    // Propagation passes in the last `Solve`, and lanes it finished
+    size_t passes = 0;
+    size_t propagated = 0;
+};
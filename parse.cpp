@@ -0,0 +1,280 @@
+#include <stdexcept>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include "parse.h"
+
+static bool IsSeparator(char c) {
+    return c == ' ' || c == '\t' || c == ',' || c == ';';
+}
+
+static bool IsSquare(size_t x, size_t& root) {
+    root = (size_t)std::sqrt((double)x);
+    while (root * root > x) root--;
+    while ((root + 1) * (root + 1) <= x) root++;
+    return root * root == x;
+}
+
+int DecodeCell(char c, size_t n) {
+    if (c == '*' || c == '.' || c == '0') return 0;
+    if (c >= '1' && c <= '9') return n <= 9 ? c - '0' : -1;
+    if (c >= 'a' && c <= 'z') c = c - 'a' + 'A';
+    if (c >= 'A' && c <= 'Z') return n > 9 ? c - 'A' + 1 : -1;
+    return -1;
+}
+
+const char* ParseStatusMessage(ParseStatus status) {
+    switch (status) {
+        case ParseStatus::Ok: return "Ok";
+        case ParseStatus::Empty: return "Empty puzzle";
+        case ParseStatus::BadCell: return "Invalid cell";
+        case ParseStatus::NotSquare: return "Board isn't square";
+        case ParseStatus::RowCount: return "Wrong number of rows";
+        case ParseStatus::RowLength: return "Row has the wrong number of cells";
+        case ParseStatus::OutOfRange: return "Value out of range";
+        case ParseStatus::TooLarge: return "Board is too large";
+    }
+    return "Unknown error";
+}
+
+static bool HasSeparators(const char* begin, const char* end) {
+    for (const char* c = begin; c < end; ++c) {
+        if (IsSeparator(*c)) return true;
+    }
+    return false;
+}
+
+// Appends the separated tokens in [begin, end) to `cells`: numbers, letters
+// or blanks. Letters are allowed regardless of the board size here.
+static ParseStatus ParseTokens(
+    const char* begin,
+    const char* end,
+    std::vector<int>& cells
+) {
+    const char* p = begin;
+    while (p < end) {
+        while (p < end && IsSeparator(*p)) p++;
+        if (p == end) break;
+        const char* token = p;
+        while (p < end && !IsSeparator(*p)) p++;
+
+        int value = 0;
+        if (p - token == 1 && (*token < '0' || *token > '9')) {
+            value = DecodeCell(*token, 26);
+        } else {
+            for (const char* c = token; c < p; ++c) {
+                if (*c < '0' || *c > '9' || value > 1000) {
+                    return ParseStatus::BadCell;
+                }
+                value = (value * 10) + (*c - '0');
+            }
+        }
+        if (value < 0) return ParseStatus::BadCell;
+        cells.push_back(value);
+    }
+    return ParseStatus::Ok;
+}
+
+// Appends one row to `cells`. `n` is only needed to decode single-character
+// cells, separated tokens don't depend on it.
+static ParseStatus ParseRow(
+    const char* begin,
+    const char* end,
+    size_t n,
+    std::vector<int>& cells
+) {
+    if (HasSeparators(begin, end)) return ParseTokens(begin, end, cells);
+    for (const char* c = begin; c < end; ++c) {
+        int value = DecodeCell(*c, n);
+        if (value < 0) return ParseStatus::BadCell;
+        cells.push_back(value);
+    }
+    return ParseStatus::Ok;
+}
+
+ParseStatus CheckBoard(size_t n, const int* cells) {
+    size_t m;
+    if (n == 0 || !IsSquare(n, m)) return ParseStatus::NotSquare;
+    if (n > max_board_n) return ParseStatus::TooLarge;
+    for (size_t i = 0; i < n * n; ++i) {
+        if (cells[i] < 0 || cells[i] > (int)n) return ParseStatus::OutOfRange;
+    }
+    return ParseStatus::Ok;
+}
+
+namespace {
+    // Line ranges with trailing whitespace and `\r` trimmed. Empty lines are
+    // skipped.
+    struct LineIter {
+        const char* p;
+        const char* end;
+
+        bool Next(const char*& line, const char*& line_end) {
+            while (p < end) {
+                const char* newline = (const char*)memchr(p, '\n', end - p);
+                line = p;
+                line_end = newline ? newline : end;
+                p = line_end + 1;
+                while (line_end > line && (
+                    line_end[-1] == ' ' ||
+                    line_end[-1] == '\t' ||
+                    line_end[-1] == '\r'
+                )) {
+                    line_end--;
+                }
+                if (line_end > line) return true;
+            }
+            return false;
+        }
+    };
+
+    bool IsHeader(const char* begin, const char* end) {
+        if (end - begin > 2) return false;
+        for (const char* c = begin; c < end; ++c) {
+            if (*c < '0' || *c > '9') return false;
+        }
+        return true;
+    }
+}
+
+ParseStatus TryParseBoard(
+    const char* begin,
+    const char* end,
+    size_t& n,
+    std::vector<int>& cells
+) {
+    LineIter lines = { begin, end };
+    const char* first;
+    const char* first_end;
+    if (!lines.Next(first, first_end)) return ParseStatus::Empty;
+
+    const char* line;
+    const char* line_end;
+    LineIter rest = lines;
+    if (!rest.Next(line, line_end)) {
+        // Whole board on one line
+        return ParseLine(first, first_end, n, cells);
+    }
+
+    cells.clear();
+    size_t n_rows = 0;
+    if (IsHeader(first, first_end)) {
+        n = 0;
+        for (const char* c = first; c < first_end; ++c) {
+            n = (n * 10) + (*c - '0');
+        }
+    } else {
+        // No header, the first row gives the size
+        n = first_end - first;
+        if (HasSeparators(first, first_end)) {
+            ParseStatus status = ParseTokens(first, first_end, cells);
+            if (status != ParseStatus::Ok) return status;
+            n = cells.size();
+            cells.clear();
+        }
+        lines = LineIter { first, end };
+    }
+
+    while (lines.Next(line, line_end)) {
+        if (++n_rows > n) return ParseStatus::RowCount;
+        size_t size = cells.size();
+        ParseStatus status = ParseRow(line, line_end, n, cells);
+        if (status != ParseStatus::Ok) return status;
+        if (cells.size() - size != n) return ParseStatus::RowLength;
+    }
+    if (n_rows != n) return ParseStatus::RowCount;
+
+    return CheckBoard(n, cells.data());
+}
+
+std::vector<int> ParseBoard(const std::string& text, size_t& n) {
+    std::vector<int> cells;
+    ParseStatus status = TryParseBoard(
+        text.data(), text.data() + text.size(), n, cells
+    );
+    if (status != ParseStatus::Ok) {
+        throw std::invalid_argument(ParseStatusMessage(status));
+    }
+    return cells;
+}
+
+namespace {
+    // Cell values by character, for boards up to 9x9 (digits) and bigger
+    // boards (letters). -1 is not a cell, -2 is a separator.
+    struct CellTables {
+        int8_t small[256];
+        int8_t large[256];
+        CellTables() {
+            for (int c = 0; c < 256; ++c) {
+                small[c] = IsSeparator(c) ? -2 : DecodeCell(c, 9);
+                large[c] = IsSeparator(c) ? -2 : DecodeCell(c, 16);
+            }
+        }
+    };
+    const CellTables cell_tables;
+}
+
+ParseStatus ParseLine(
+    const char* begin,
+    const char* end,
+    size_t& n,
+    std::vector<int>& cells
+) {
+    while (end > begin && (end[-1] == '\r' || end[-1] == ' ')) end--;
+    size_t len = end - begin;
+
+    // One character per cell: the length gives the size
+    unsigned size = 0;
+    switch (len) {
+        case 16: size = 4; break;
+        case 81: size = 9; break;
+        case 256: size = 16; break;
+        case 625: size = 25; break;
+    }
+    if (size > 0) {
+        n = size;
+        const int8_t* table =
+            size <= 9 ? cell_tables.small : cell_tables.large;
+        cells.resize(len);
+        int* out = cells.data();
+        const unsigned char* in = (const unsigned char*)begin;
+        unsigned bad = 0;
+        for (size_t i = 0; i < len; ++i) {
+            int value = table[in[i]];
+            // Negative values wrap around and are caught too
+            bad |= (unsigned)value > size;
+            out[i] = value;
+        }
+        if (!bad) return ParseStatus::Ok;
+        // Might still be a separated line that happens to have this length,
+        // fall through
+    }
+
+    // Separated tokens
+    cells.clear();
+    ParseStatus status = ParseTokens(begin, end, cells);
+    if (status != ParseStatus::Ok) return status;
+    if (cells.empty()) return ParseStatus::Empty;
+    if (!IsSquare(cells.size(), n)) return ParseStatus::NotSquare;
+    return CheckBoard(n, cells.data());
+}
+
+static char EncodeCell(int x, size_t n, char blank) {
+    if (x == 0) return blank;
+    return n <= 9 ? '0' + x : 'A' + x - 1;
+}
+
+void FormatBoard(const std::vector<int>& board, size_t n, std::string& out) {
+    out.clear();
+    for (int x : board) {
+        out += EncodeCell(x, n, '.');
+    }
+}
+
+void FormatRows(const std::vector<int>& board, size_t n, std::string& out) {
+    out = std::to_string(n) + "\n";
+    for (size_t i = 0; i < board.size(); ++i) {
+        out += EncodeCell(board[i], n, '*');
+        if ((i + 1) % n == 0) out += '\n';
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Why a board couldn't be parsed. Parsing reports errors as a status rather
+// than an exception, so malformed input is cheap to reject.
+enum class ParseStatus {
+    Ok,
+    Empty,
+    BadCell,
+    NotSquare,
+    RowCount,
+    RowLength,
+    OutOfRange,
+    TooLarge
+};
+
+// Largest board the solvers handle, 25x25 (cells `A`-`Y`)
+const size_t max_board_n = 25;
+
+const char* ParseStatusMessage(ParseStatus status);
+
+// Decodes a puzzle in any of the supported text formats:
+// - `n` on the first line, then `n` rows (the format in `tests/`)
+// - `n` rows without the header line
+// - the whole board on a single line, e.g. 81 characters for a 9x9 board
+//
+// Within a row, cells are either one character each, or separated by
+// whitespace or commas, which allows multi-digit values. Values are `1`-`9`,
+// or letters `A`-`Y` (`A` is 1) for boards bigger than 9x9. Blanks are `*`,
+// `.` or `0`, and are returned as 0.
+//
+// Decodes the text in [begin, end) into `cells`, reusing its storage.
+ParseStatus TryParseBoard(
+    const char* begin,
+    const char* end,
+    size_t& n,
+    std::vector<int>& cells
+);
+
+// Like `TryParseBoard`, but throws `std::invalid_argument` if the text is
+// malformed
+std::vector<int> ParseBoard(const std::string& text, size_t& n);
+
+// Checks that `n` is a square no bigger than `max_board_n`, and the `n * n`
+// cells are in [0, n]
+ParseStatus CheckBoard(size_t n, const int* cells);
+
+// Returns the value of a single-character cell, 0 for a blank, or -1 if `c`
+// isn't a cell
+int DecodeCell(char c, size_t n);
+
+// Decodes a puzzle on a single line in [begin, end), in place and without
+// allocating once `cells` has grown to the board size. Accepts the same
+// single-line formats as `ParseBoard`; a trailing `\r` is ignored.
+ParseStatus ParseLine(
+    const char* begin,
+    const char* end,
+    size_t& n,
+    std::vector<int>& cells
+);
+
+// Writes `board` on a single line into `out`, in the same encoding that
+// `ParseBoard` reads. Blanks are written as `.`.
+void FormatBoard(const std::vector<int>& board, size_t n, std::string& out);
+
+// Writes `board` as `n` followed by one line per row, the format of the
+// puzzles in `tests/`. Blanks are written as `*`.
+void FormatRows(const std::vector<int>& board, size_t n, std::string& out);
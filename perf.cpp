@@ -0,0 +1,175 @@
+#include <atomic>
+#include "perf.h"
+
+#ifdef __linux__
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+const char* PerfEventName(PerfEvent event) {
+    switch (event) {
+        case PerfEvent::Cycles: return "cycles";
+        case PerfEvent::Instructions: return "instructions";
+        case PerfEvent::L1dMisses: return "l1d_misses";
+        case PerfEvent::LlcMisses: return "llc_misses";
+        case PerfEvent::BranchMisses: return "branch_misses";
+        case PerfEvent::Count: break;
+    }
+    return "none";
+}
+
+bool PerfCounts::Any() const {
+    for (size_t e = 0; e < n_perf_events; ++e) {
+        if (valid[e]) return true;
+    }
+    return false;
+}
+
+PerfCounts& PerfCounts::operator +=(const PerfCounts& other) {
+    for (size_t e = 0; e < n_perf_events; ++e) {
+        values[e] += other.values[e];
+        valid[e] = valid[e] || other.valid[e];
+    }
+    return *this;
+}
+
+PerfCounts PerfDelta(const PerfCounts& start, const PerfCounts& end) {
+    PerfCounts delta;
+    for (size_t e = 0; e < n_perf_events; ++e) {
+        delta.valid[e] = start.valid[e] && end.valid[e];
+        if (delta.valid[e] && end.values[e] >= start.values[e]) {
+            delta.values[e] = end.values[e] - start.values[e];
+        }
+    }
+    return delta;
+}
+
+namespace {
+    std::atomic<bool> perf_enabled(false);
+
+#ifdef __linux__
+    // One group per thread, led by the first event that opened, so a single
+    // `read` returns every count
+    class PerfGroup {
+    private:
+        int fds[n_perf_events];
+        int leader;
+        // Position of each event in the group's read, -1 if not counted
+        int slots[n_perf_events];
+        int n_open;
+
+        static int Open(uint32_t type, uint64_t config, int group) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format =
+                PERF_FORMAT_GROUP |
+                PERF_FORMAT_TOTAL_TIME_ENABLED |
+                PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+        }
+
+    public:
+        PerfGroup() : leader(-1), n_open(0) {
+            const uint64_t l1d_read_miss =
+                PERF_COUNT_HW_CACHE_L1D |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            const uint32_t types[n_perf_events] = {
+                PERF_TYPE_HARDWARE,
+                PERF_TYPE_HARDWARE,
+                PERF_TYPE_HW_CACHE,
+                PERF_TYPE_HARDWARE,
+                PERF_TYPE_HARDWARE
+            };
+            const uint64_t configs[n_perf_events] = {
+                PERF_COUNT_HW_CPU_CYCLES,
+                PERF_COUNT_HW_INSTRUCTIONS,
+                l1d_read_miss,
+                PERF_COUNT_HW_CACHE_MISSES,
+                PERF_COUNT_HW_BRANCH_MISSES
+            };
+
+            for (size_t e = 0; e < n_perf_events; ++e) {
+                fds[e] = Open(types[e], configs[e], leader);
+                slots[e] = -1;
+                if (fds[e] < 0) continue;
+                if (leader < 0) leader = fds[e];
+                slots[e] = n_open++;
+            }
+        }
+
+        ~PerfGroup() {
+            for (size_t e = 0; e < n_perf_events; ++e) {
+                if (fds[e] >= 0) close(fds[e]);
+            }
+        }
+
+        inline bool Open() { return n_open > 0; }
+
+        PerfCounts Read() {
+            PerfCounts counts;
+            if (n_open == 0) return counts;
+
+            // nr, time enabled, time running, then one value per event
+            uint64_t buffer[3 + n_perf_events];
+            ssize_t size = read(leader, buffer, sizeof(buffer));
+            if (size < (ssize_t)(3 * sizeof(uint64_t))) return counts;
+            uint64_t enabled = buffer[1];
+            uint64_t running = buffer[2];
+            if (running == 0) return counts;
+
+            for (size_t e = 0; e < n_perf_events; ++e) {
+                if (slots[e] < 0 || (uint64_t)slots[e] >= buffer[0]) {
+                    continue;
+                }
+                uint64_t value = buffer[3 + slots[e]];
+                // Scaled up if the kernel had to multiplex the counters
+                if (running < enabled) {
+                    value = (uint64_t)((double)value * enabled / running);
+                }
+                counts.values[e] = value;
+                counts.valid[e] = true;
+            }
+            return counts;
+        }
+    };
+
+    PerfGroup& ThreadGroup() {
+        thread_local PerfGroup group;
+        return group;
+    }
+#endif
+}
+
+void EnablePerfCounters(bool enable) {
+    perf_enabled = enable;
+}
+
+bool PerfCountersEnabled() {
+    return perf_enabled.load(std::memory_order_relaxed);
+}
+
+bool PerfCountersAvailable() {
+#ifdef __linux__
+    return ThreadGroup().Open();
+#else
+    return false;
+#endif
+}
+
+PerfCounts ReadPerfCounters() {
+#ifdef __linux__
+    // The thread's group is only touched once enabled, so disabled builds
+    // never open counters
+    if (PerfCountersEnabled()) return ThreadGroup().Read();
+#endif
+    return PerfCounts();
+}
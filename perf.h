@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Hardware events counted around solver phases
+enum class PerfEvent {
+    Cycles,
+    Instructions,
+    // L1 data cache read misses
+    L1dMisses,
+    // Last level cache misses
+    LlcMisses,
+    BranchMisses,
+    Count
+};
+
+const size_t n_perf_events = (size_t)PerfEvent::Count;
+
+const char* PerfEventName(PerfEvent event);
+
+// Counts of one thread, or summed over threads. An event the machine won't
+// count (no permission, no PMU in a VM, not Linux) stays invalid rather than
+// reading as 0.
+struct PerfCounts {
+    uint64_t values[n_perf_events] = {};
+    bool valid[n_perf_events] = {};
+
+    inline uint64_t Get(PerfEvent event) const {
+        return values[(size_t)event];
+    }
+    inline bool Valid(PerfEvent event) const {
+        return valid[(size_t)event];
+    }
+    bool Any() const;
+
+    // Valid where either side is
+    PerfCounts& operator +=(const PerfCounts& other);
+};
+
+// Off by default. Once enabled, every timed phase (see `PhaseTimer`) also
+// reads the hardware counters of the thread running it, at the cost of a
+// `read` syscall at its start and end. Counters are opened per thread on
+// first use, with `perf_event_open`, and count user space only.
+void EnablePerfCounters(bool enable = true);
+bool PerfCountersEnabled();
+
+// Opens the calling thread's counters if needed. False if none of the
+// events can be counted, in which case phases go on without counts.
+bool PerfCountersAvailable();
+
+// The calling thread's counts so far; all invalid while disabled
+PerfCounts ReadPerfCounters();
+
+// Counts between two reads of the same thread
+PerfCounts PerfDelta(const PerfCounts& start, const PerfCounts& end);
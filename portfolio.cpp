@@ -0,0 +1,174 @@
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include "portfolio.h"
+#include "exact.h"
+
+const char* PortfolioEngineName(PortfolioEngine engine) {
+    switch (engine) {
+        case PortfolioEngine::Exact: return "exact";
+        case PortfolioEngine::HillClimber: return "hill";
+        case PortfolioEngine::Genetic: return "genetic";
+        case PortfolioEngine::Count: break;
+    }
+    return "none";
+}
+
+namespace {
+    // States point at the engine's copy of the problem
+    void Rebind(Checkpoint& checkpoint, Problem* problem) {
+        checkpoint.best.problem = problem;
+        for (auto& s : checkpoint.population) s.problem = problem;
+    }
+}
+
+Portfolio::Portfolio(PortfolioOptions options) : runs(0), options(options) {
+    for (auto& w : wins) w = 0;
+}
+
+void Portfolio::Allocate(size_t* threads) {
+    const size_t n = n_portfolio_engines;
+    size_t extra = options.n_threads > n ? options.n_threads - n : 0;
+
+    // Extra threads in proportion to wins + 1, largest remainders first
+    size_t weights[n];
+    size_t total = 0;
+    for (size_t e = 0; e < n; ++e) {
+        weights[e] = options.even ? 1 : wins[e] + 1;
+        total += weights[e];
+    }
+    size_t given = 0;
+    size_t remainders[n];
+    for (size_t e = 0; e < n; ++e) {
+        threads[e] = 1 + (extra * weights[e]) / total;
+        remainders[e] = (extra * weights[e]) % total;
+        given += threads[e] - 1;
+    }
+    while (given < extra) {
+        size_t best = 0;
+        for (size_t e = 1; e < n; ++e) {
+            if (remainders[e] > remainders[best]) best = e;
+        }
+        threads[best]++;
+        remainders[best] = 0;
+        given++;
+    }
+}
+
+Checkpoint Portfolio::Solve(Problem& problem, PortfolioEngine* winner) {
+    SolverStats race;
+    PhaseTimer race_timer(race.total_time);
+    size_t threads[n_portfolio_engines];
+    Allocate(threads);
+
+    // One runner per hill climber, one for the genetic algorithm (which
+    // starts its own workers) and one for the exact search
+    std::vector<PortfolioEngine> engines;
+    engines.push_back(PortfolioEngine::Exact);
+    engines.push_back(PortfolioEngine::Genetic);
+    size_t n_climbers = threads[(size_t)PortfolioEngine::HillClimber];
+    for (size_t k = 0; k < n_climbers; ++k) {
+        engines.push_back(PortfolioEngine::HillClimber);
+    }
+
+    const std::atomic<bool>* external = problem.budget.cancel;
+    std::atomic<bool> done(external && external->load());
+    std::vector<Problem> copies(engines.size(), problem);
+    for (auto& copy : copies) {
+        copy.progress = nullptr;
+        copy.trace = nullptr;
+        copy.budget.cancel = &done;
+    }
+
+    std::mutex mutex;
+    std::condition_variable finished_cv;
+    std::vector<Checkpoint> results(engines.size());
+    size_t finished = 0;
+    size_t decisive = engines.size();
+
+    std::vector<std::thread> runners;
+    for (size_t r = 0; r < engines.size(); ++r) {
+        runners.push_back(std::thread([&, r] () {
+            Problem& copy = copies[r];
+            Checkpoint result;
+            switch (engines[r]) {
+                case PortfolioEngine::Exact:
+                    result = SolveExact(
+                        copy, threads[(size_t)PortfolioEngine::Exact]
+                    );
+                    break;
+                case PortfolioEngine::HillClimber:
+                    result = copy.HillClimber(Checkpoint());
+                    break;
+                default:
+                    result = copy.Genetic(
+                        Checkpoint(),
+                        options.population,
+                        options.mutate_prob,
+                        options.terminate_streak,
+                        0,
+                        options.crossover,
+                        threads[(size_t)PortfolioEngine::Genetic]
+                    );
+                    break;
+            }
+
+            // Finding the goal ends the race, and so does the exact search
+            // finishing without one, since then there is none
+            bool wins_race =
+                result.is_goal ||
+                (engines[r] == PortfolioEngine::Exact &&
+                    result.stopped == BudgetStop::None);
+            std::lock_guard<std::mutex> lock(mutex);
+            results[r] = result;
+            finished++;
+            if (wins_race && decisive == engines.size()) {
+                decisive = r;
+                done = true;
+            }
+            finished_cv.notify_all();
+        }));
+    }
+
+    {
+        // Also forwards an external cancel to the engines
+        std::unique_lock<std::mutex> lock(mutex);
+        while (finished < engines.size()) {
+            finished_cv.wait_for(lock, std::chrono::milliseconds(1));
+            if (external && external->load()) done = true;
+        }
+    }
+    for (auto& t : runners) t.join();
+
+    size_t chosen = decisive;
+    if (chosen == engines.size()) {
+        // Nobody won: the lowest conflicts among the local searches
+        for (size_t r = 0; r < engines.size(); ++r) {
+            if (engines[r] == PortfolioEngine::Exact) continue;
+            if (
+                chosen == engines.size() ||
+                results[r].best.Eval() < results[chosen].best.Eval()
+            ) {
+                chosen = r;
+            }
+        }
+    }
+
+    Checkpoint checkpoint = results[chosen];
+    Rebind(checkpoint, &problem);
+    // Counters of every engine, but the wall time of the race
+    checkpoint.stats = SolverStats();
+    for (auto& result : results) checkpoint.stats += result.stats;
+    race_timer.Stop();
+    checkpoint.stats.total_time = race.total_time;
+
+    runs++;
+    if (decisive < engines.size()) wins[(size_t)engines[decisive]]++;
+    if (winner) {
+        *winner = decisive < engines.size() ?
+            engines[decisive] : PortfolioEngine::Count;
+    }
+    return checkpoint;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include "lib.h"
+
+enum class PortfolioEngine {
+    Exact,
+    HillClimber,
+    Genetic,
+    Count
+};
+
+const size_t n_portfolio_engines = (size_t)PortfolioEngine::Count;
+
+const char* PortfolioEngineName(PortfolioEngine engine);
+
+struct PortfolioOptions {
+    // Threads for all engines together. Every engine gets at least one, the
+    // rest go to the engines that won most often.
+    size_t n_threads = 3;
+    // Spread the extra threads evenly instead
+    bool even = false;
+
+    // Genetic parameters, as for `TestHarnessGenetic`
+    size_t population = 200;
+    double mutate_prob = 0.1;
+    size_t terminate_streak = 200;
+    Problem::CrossoverType crossover = Problem::CrossoverType::Uniform;
+};
+
+// Races the exact search, hill climbing and the genetic algorithm on the same
+// puzzle, each on its own copy of the problem and its own threads. The first
+// engine to find the goal (or the exact search proving there is none)
+// cancels the others through their budget. `problem.budget` limits the
+// whole race.
+//
+// Wins are counted over every `Solve`, so one portfolio shared by batch
+// workers learns which engine suits the batch: an engine with extra threads
+// runs more hill climbers, more genetic worker threads, or more exact search
+// threads.
+class Portfolio {
+private:
+    std::atomic<size_t> wins[n_portfolio_engines];
+    std::atomic<size_t> runs;
+
+public:
+    PortfolioOptions options;
+
+    Portfolio(PortfolioOptions options = PortfolioOptions());
+
+    // Threads each engine gets in the next `Solve`, by `PortfolioEngine`
+    void Allocate(size_t* threads);
+
+    // Returns the winner's checkpoint, or the best state any engine found if
+    // none won. `winner` is set to `PortfolioEngine::Count` when none won.
+    Checkpoint Solve(Problem& problem, PortfolioEngine* winner = nullptr);
+
+    inline size_t Wins(PortfolioEngine engine) {
+        return wins[(size_t)engine];
+    }
+    inline size_t Runs() { return runs; }
+};
@@ -0,0 +1,75 @@
+#include <cstdarg>
+#include <cstdio>
+#include <algorithm>
+#include "progress.h"
+#include "lib.h"
+
+StreamProgress::StreamProgress(
+    std::ostream& out,
+    size_t interval,
+    int verbosity,
+    size_t flush_size
+) : Progress(interval, verbosity), out(out), flush_size(flush_size) {
+    buffer.reserve(flush_size + 256);
+}
+
+StreamProgress::~StreamProgress() {
+    Flush();
+}
+
+void StreamProgress::Append(const char* format, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (len > 0) {
+        buffer.append(line, std::min((size_t)len, sizeof(line) - 1));
+    }
+}
+
+void StreamProgress::Report(const ProgressEvent& event) {
+    if (verbosity >= 2 && event.state && !event.done) {
+        for (int x : event.state->data) {
+            Append("%d ", x);
+        }
+    }
+
+    switch (event.engine) {
+        case ProgressEvent::Engine::HillClimber:
+            if (!event.done) {
+                Append("%3d / %zu\n", event.eval, event.iter);
+            } else if (event.visited_lookups > 0) {
+                Append(
+                    "Visited: %zu / %zu\n",
+                    event.visited_hits, event.visited_lookups
+                );
+            }
+            break;
+        case ProgressEvent::Engine::Genetic:
+            if (!event.done) {
+                Append(
+                    "%3d / %d / %zu / %zu / %.3f / %.3f / %zu\n",
+                    event.eval,
+                    event.goal_eval,
+                    event.streak,
+                    event.iter,
+                    event.diversity,
+                    event.mutate_rate,
+                    event.restarts
+                );
+            }
+            break;
+    }
+
+    if (event.done || buffer.size() >= flush_size) {
+        Flush();
+    }
+}
+
+void StreamProgress::Flush() {
+    if (buffer.empty()) return;
+    out.write(buffer.data(), buffer.size());
+    out.flush();
+    buffer.clear();
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <ostream>
+#include <functional>
+
+struct State;
+
+// Snapshot of a solver, handed to a `Progress` sink
+struct ProgressEvent {
+    enum class Engine {
+        HillClimber,
+        Genetic
+    };
+    Engine engine;
+
+    // Set on the last event of a run, which is always reported
+    bool done = false;
+
+    size_t iter = 0;
+    const State* state = nullptr;
+    int eval = 0;
+
+    // Genetic only
+    int goal_eval = 0;
+    size_t streak = 0;
+    double diversity = 0;
+    double mutate_rate = 0;
+    size_t restarts = 0;
+
+    // HillClimber visited set
+    size_t visited_hits = 0;
+    size_t visited_lookups = 0;
+};
+
+// Receives progress from the solvers. Solvers call `Sample` every iteration
+// and only build an event when it returns true.
+//
+// `verbosity`:
+// - 0: silent
+// - 1: one line of numbers per sampled iteration
+// - 2: also print the board
+class Progress {
+public:
+    size_t interval;
+    int verbosity;
+
+    Progress(size_t interval = 1, int verbosity = 1)
+        : interval(interval), verbosity(verbosity) { }
+    virtual ~Progress() { }
+
+    inline bool Sample(size_t iter) {
+        return verbosity > 0 && iter % interval == 0;
+    }
+    inline bool Enabled() { return verbosity > 0; }
+
+    virtual void Report(const ProgressEvent& event) = 0;
+};
+
+class SilentProgress : public Progress {
+public:
+    SilentProgress() : Progress(1, 0) { }
+    void Report(const ProgressEvent&) override { }
+};
+
+class CallbackProgress : public Progress {
+private:
+    std::function<void(const ProgressEvent&)> callback;
+public:
+    CallbackProgress(
+        std::function<void(const ProgressEvent&)> callback,
+        size_t interval = 1,
+        int verbosity = 1
+    ) : Progress(interval, verbosity), callback(callback) { }
+
+    void Report(const ProgressEvent& event) override { callback(event); }
+};
+
+// Formats events into a buffer and writes it to `out` in large chunks, with
+// no flush per line. Flushed when the buffer fills, when a run is done and on
+// destruction.
+class StreamProgress : public Progress {
+private:
+    std::ostream& out;
+    std::string buffer;
+    size_t flush_size;
+    void Append(const char* format, ...);
+public:
+    StreamProgress(
+        std::ostream& out,
+        size_t interval = 1,
+        int verbosity = 2,
+        size_t flush_size = 1 << 16
+    );
+    ~StreamProgress();
+
+    void Report(const ProgressEvent& event) override;
+    void Flush();
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded lock-free queue for any number of producers and consumers, after
+// Dmitry Vyukov's MPMC ring. Each slot carries a sequence number telling
+// whether it's ready to be written or read, so a push or pop is a single
+// compare-and-swap on the shared position. `capacity` is rounded up to a
+// power of two.
+template<class T>
+class BoundedQueue {
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    // Kept on separate cache lines so producers and consumers don't contend
+    alignas(64) std::atomic<size_t> push_pos;
+    alignas(64) std::atomic<size_t> pop_pos;
+
+public:
+    BoundedQueue(size_t capacity) : push_pos(0), pop_pos(0) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        slots.reset(new Slot[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator =(const BoundedQueue&) = delete;
+
+    // Returns false if the queue is full
+    bool TryPush(const T& value) {
+        size_t pos = push_pos.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[pos & mask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (push_pos.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed
+                )) {
+                    slot.value = value;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = push_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Returns false if the queue is empty
+    bool TryPop(T& value) {
+        size_t pos = pop_pos.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[pos & mask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (pop_pos.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed
+                )) {
+                    value = slot.value;
+                    slot.sequence.store(
+                        pos + mask + 1, std::memory_order_release
+                    );
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = pop_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Approximate number of queued values, for statistics
+    size_t Depth() {
+        size_t push = push_pos.load(std::memory_order_relaxed);
+        size_t pop = pop_pos.load(std::memory_order_relaxed);
+        return push > pop ? push - pop : 0;
+    }
+
+    inline size_t Capacity() { return mask + 1; }
+};
@@ -0,0 +1,360 @@
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include "rate.h"
+
+const char* TechniqueName(Technique technique) {
+    switch (technique) {
+        case Technique::HiddenSingle: return "hidden_single";
+        case Technique::NakedSingle: return "naked_single";
+        case Technique::Pointing: return "pointing";
+        case Technique::Claiming: return "claiming";
+        case Technique::NakedPair: return "naked_pair";
+        case Technique::HiddenPair: return "hidden_pair";
+        case Technique::XWing: return "x_wing";
+        case Technique::Count: break;
+    }
+    return "unknown";
+}
+
+double TechniqueWeight(Technique technique) {
+    switch (technique) {
+        case Technique::HiddenSingle: return 1.0;
+        case Technique::NakedSingle: return 1.5;
+        case Technique::Pointing: return 2.5;
+        case Technique::Claiming: return 2.8;
+        case Technique::NakedPair: return 3.0;
+        case Technique::HiddenPair: return 3.4;
+        case Technique::XWing: return 4.0;
+        case Technique::Count: break;
+    }
+    return guess_weight;
+}
+
+Rater::Rater() : n(0), box(0), n_blanks(0), contradiction(false) { }
+
+void Rater::Init(size_t n) {
+    if (n == this->n) return;
+    this->n = n;
+    box = (size_t)std::round(std::sqrt((double)n));
+
+    units.resize(3 * n * n);
+    cell_units.resize(3 * n * n);
+    for (size_t i = 0; i < n * n; ++i) {
+        size_t row = i / n;
+        size_t col = i % n;
+        size_t b = ((row / box) * box) + (col / box);
+        size_t k = ((row % box) * box) + (col % box);
+        units[(row * n) + col] = i;
+        units[((n + col) * n) + row] = i;
+        units[(((2 * n) + b) * n) + k] = i;
+        cell_units[(i * 3) + 0] = row;
+        cell_units[(i * 3) + 1] = n + col;
+        cell_units[(i * 3) + 2] = (2 * n) + b;
+    }
+
+    // Row and column peers, plus the box cells in neither
+    peers_per_cell = (2 * (n - 1)) + ((box - 1) * (box - 1));
+    peers.resize(n * n * peers_per_cell);
+    for (size_t i = 0; i < n * n; ++i) {
+        int* p = &peers[i * peers_per_cell];
+        for (size_t u = 0; u < 3; ++u) {
+            const int* unit = Unit(cell_units[(i * 3) + u]);
+            for (size_t k = 0; k < n; ++k) {
+                size_t j = unit[k];
+                if (j == i) continue;
+                if (u == 2 && (j / n == i / n || j % n == i % n)) continue;
+                *p++ = j;
+            }
+        }
+    }
+}
+
+void Rater::Place(int i, int value) {
+    uint32_t bit = 1u << value;
+    board[i] = value;
+    candidates[i] = 0;
+    n_blanks--;
+    const int* p = &peers[i * peers_per_cell];
+    for (size_t k = 0; k < peers_per_cell; ++k) {
+        int j = p[k];
+        if (board[j] == value) contradiction = true;
+        if (board[j] == 0) {
+            candidates[j] &= ~bit;
+            if (candidates[j] == 0) contradiction = true;
+        }
+    }
+}
+
+bool Rater::Eliminate(int i, uint32_t mask) {
+    if (board[i] != 0 || !(candidates[i] & mask)) return false;
+    candidates[i] &= ~mask;
+    if (candidates[i] == 0) contradiction = true;
+    return true;
+}
+
+bool Rater::HiddenSingle() {
+    for (size_t u = 0; u < 3 * n; ++u) {
+        const int* unit = Unit(u);
+        uint32_t once = 0;
+        uint32_t twice = 0;
+        for (size_t k = 0; k < n; ++k) {
+            uint32_t c = candidates[unit[k]];
+            twice |= once & c;
+            once |= c;
+        }
+        uint32_t singles = once & ~twice;
+        if (!singles) continue;
+
+        for (size_t k = 0; k < n; ++k) {
+            int i = unit[k];
+            uint32_t single = candidates[i] & singles;
+            if (!single) continue;
+            if (single & (single - 1)) {
+                // Two values that can only go in the same cell
+                contradiction = true;
+                return true;
+            }
+            Place(i, __builtin_ctz(single));
+        }
+        return true;
+    }
+    return false;
+}
+
+bool Rater::NakedSingle() {
+    bool progress = false;
+    for (size_t i = 0; i < n * n; ++i) {
+        uint32_t c = candidates[i];
+        if (c && !(c & (c - 1))) {
+            Place(i, __builtin_ctz(c));
+            progress = true;
+        }
+    }
+    return progress;
+}
+
+bool Rater::Pointing() {
+    // A value confined to one row or column of a box can be removed from the
+    // rest of that row or column
+    for (size_t b = 0; b < n; ++b) {
+        const int* unit = Unit((2 * n) + b);
+        for (size_t value = 1; value <= n; ++value) {
+            uint32_t bit = 1u << value;
+            uint32_t rows = 0;
+            uint32_t cols = 0;
+            for (size_t k = 0; k < n; ++k) {
+                int i = unit[k];
+                if (candidates[i] & bit) {
+                    rows |= 1u << (i / n);
+                    cols |= 1u << (i % n);
+                }
+            }
+            bool progress = false;
+            if (rows && !(rows & (rows - 1))) {
+                const int* row = Unit(__builtin_ctz(rows));
+                for (size_t k = 0; k < n; ++k) {
+                    if (cell_units[(row[k] * 3) + 2] == (int)((2 * n) + b)) {
+                        continue;
+                    }
+                    progress |= Eliminate(row[k], bit);
+                }
+            }
+            if (cols && !(cols & (cols - 1))) {
+                const int* col = Unit(n + __builtin_ctz(cols));
+                for (size_t k = 0; k < n; ++k) {
+                    if (cell_units[(col[k] * 3) + 2] == (int)((2 * n) + b)) {
+                        continue;
+                    }
+                    progress |= Eliminate(col[k], bit);
+                }
+            }
+            if (progress) return true;
+        }
+    }
+    return false;
+}
+
+bool Rater::Claiming() {
+    // A value confined to one box within a row or column can be removed from
+    // the rest of that box
+    for (size_t u = 0; u < 2 * n; ++u) {
+        const int* line = Unit(u);
+        size_t line_kind = u < n ? 0 : 1;
+        for (size_t value = 1; value <= n; ++value) {
+            uint32_t bit = 1u << value;
+            uint32_t boxes = 0;
+            for (size_t k = 0; k < n; ++k) {
+                int i = line[k];
+                if (candidates[i] & bit) {
+                    boxes |= 1u << (cell_units[(i * 3) + 2] - (2 * n));
+                }
+            }
+            if (!boxes || (boxes & (boxes - 1))) continue;
+
+            bool progress = false;
+            const int* b = Unit((2 * n) + __builtin_ctz(boxes));
+            for (size_t k = 0; k < n; ++k) {
+                if (cell_units[(b[k] * 3) + line_kind] == (int)u) continue;
+                progress |= Eliminate(b[k], bit);
+            }
+            if (progress) return true;
+        }
+    }
+    return false;
+}
+
+bool Rater::NakedPair() {
+    for (size_t u = 0; u < 3 * n; ++u) {
+        const int* unit = Unit(u);
+        for (size_t a = 0; a < n; ++a) {
+            uint32_t pair = candidates[unit[a]];
+            if (__builtin_popcount(pair) != 2) continue;
+            for (size_t b = a + 1; b < n; ++b) {
+                if (candidates[unit[b]] != pair) continue;
+                bool progress = false;
+                for (size_t k = 0; k < n; ++k) {
+                    if (k == a || k == b) continue;
+                    progress |= Eliminate(unit[k], pair);
+                }
+                if (progress) return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool Rater::HiddenPair() {
+    uint32_t positions[32];
+    for (size_t u = 0; u < 3 * n; ++u) {
+        const int* unit = Unit(u);
+        // Where each value can go within the unit
+        std::fill(positions, positions + n + 1, 0);
+        for (size_t k = 0; k < n; ++k) {
+            uint32_t c = candidates[unit[k]];
+            while (c) {
+                positions[__builtin_ctz(c)] |= 1u << k;
+                c &= c - 1;
+            }
+        }
+        for (size_t v = 1; v <= n; ++v) {
+            if (__builtin_popcount(positions[v]) != 2) continue;
+            for (size_t w = v + 1; w <= n; ++w) {
+                if (positions[w] != positions[v]) continue;
+                uint32_t pair = (1u << v) | (1u << w);
+                uint32_t cells = positions[v];
+                bool progress = false;
+                while (cells) {
+                    int i = unit[__builtin_ctz(cells)];
+                    progress |= Eliminate(i, candidates[i] & ~pair);
+                    cells &= cells - 1;
+                }
+                if (progress) return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool Rater::XWing() {
+    // Rows then columns: if a value can only go in the same two positions of
+    // two lines, it can be removed from the crossing lines elsewhere
+    for (size_t kind = 0; kind < 2; ++kind) {
+        size_t base = kind * n;
+        size_t crossing = (1 - kind) * n;
+        for (size_t value = 1; value <= n; ++value) {
+            uint32_t bit = 1u << value;
+            uint32_t positions[32];
+            for (size_t l = 0; l < n; ++l) {
+                const int* line = Unit(base + l);
+                positions[l] = 0;
+                for (size_t k = 0; k < n; ++k) {
+                    if (candidates[line[k]] & bit) positions[l] |= 1u << k;
+                }
+            }
+            for (size_t l1 = 0; l1 < n; ++l1) {
+                if (__builtin_popcount(positions[l1]) != 2) continue;
+                for (size_t l2 = l1 + 1; l2 < n; ++l2) {
+                    if (positions[l2] != positions[l1]) continue;
+                    bool progress = false;
+                    uint32_t across = positions[l1];
+                    while (across) {
+                        size_t u = crossing + __builtin_ctz(across);
+                        const int* line = Unit(u);
+                        for (size_t k = 0; k < n; ++k) {
+                            if (k == l1 || k == l2) continue;
+                            progress |= Eliminate(line[k], bit);
+                        }
+                        across &= across - 1;
+                    }
+                    if (progress) return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool Rater::Apply(Technique technique) {
+    switch (technique) {
+        case Technique::HiddenSingle: return HiddenSingle();
+        case Technique::NakedSingle: return NakedSingle();
+        case Technique::Pointing: return Pointing();
+        case Technique::Claiming: return Claiming();
+        case Technique::NakedPair: return NakedPair();
+        case Technique::HiddenPair: return HiddenPair();
+        case Technique::XWing: return XWing();
+        case Technique::Count: break;
+    }
+    return false;
+}
+
+void Rater::Rate(Problem& problem, Rating& rating) {
+    Init(problem.n);
+    uint32_t all = ((1u << n) - 1) << 1;
+    candidates.assign(n * n, all);
+    board.assign(n * n, 0);
+    n_blanks = n * n;
+    contradiction = false;
+    for (size_t i = 0; i < n * n; ++i) {
+        int value = problem.fixed[i];
+        if (value == 0) continue;
+        if (candidates[i] & (1u << value)) {
+            Place(i, value);
+        } else {
+            contradiction = true;
+        }
+    }
+
+    std::fill(rating.steps, rating.steps + n_techniques, 0);
+    while (n_blanks > 0 && !contradiction) {
+        // Always go back to the easiest technique after progress
+        size_t t = 0;
+        while (t < n_techniques && !Apply((Technique)t)) t++;
+        if (t == n_techniques) break;
+        rating.steps[t]++;
+    }
+
+    rating.solved = n_blanks == 0 && !contradiction;
+    rating.grade = 0;
+    for (size_t t = 0; t < n_techniques; ++t) {
+        if (rating.steps[t] == 0) continue;
+        rating.grade = std::max(rating.grade, TechniqueWeight((Technique)t));
+    }
+    if (!rating.solved) rating.grade = guess_weight;
+    rating.board = board;
+}
+
+void FormatRating(const Rating& rating, std::string& out) {
+    char grade[16];
+    snprintf(grade, sizeof(grade), "%.1f", rating.grade);
+    out += grade;
+    for (size_t t = 0; t < n_techniques; ++t) {
+        if (rating.steps[t] == 0) continue;
+        out += ' ';
+        out += TechniqueName((Technique)t);
+        out += '=';
+        out += std::to_string(rating.steps[t]);
+    }
+    if (!rating.solved) out += " guess";
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "lib.h"
+
+// Human solving techniques, from easiest to hardest
+enum class Technique {
+    HiddenSingle,
+    NakedSingle,
+    Pointing,
+    Claiming,
+    NakedPair,
+    HiddenPair,
+    XWing,
+    Count
+};
+
+const size_t n_techniques = (size_t)Technique::Count;
+
+const char* TechniqueName(Technique technique);
+
+// Difficulty weight of each technique. The grade of a puzzle is the weight
+// of the hardest technique it needs.
+double TechniqueWeight(Technique technique);
+
+// Grade of a puzzle the techniques can't finish, which needs guessing
+const double guess_weight = 10;
+
+struct Rating {
+    // Whether the techniques alone solved the puzzle
+    bool solved = false;
+    double grade = 0;
+    // Times each technique made progress, by `Technique`
+    size_t steps[n_techniques] = {};
+    // The board as far as the techniques got
+    std::vector<int> board;
+};
+
+// Solves like a person would: repeatedly applies the easiest technique that
+// makes progress, either placing values or removing candidates, until the
+// board is solved or no technique applies. Buffers are reused between
+// puzzles, so keep one `Rater` per thread.
+class Rater {
+private:
+    size_t n;
+    size_t box;
+    std::vector<uint32_t> candidates;
+    std::vector<int> board;
+    size_t n_blanks;
+    bool contradiction;
+    // Cells of every row, column and box, `n` per unit
+    std::vector<int> units;
+    // Row, column and box of every cell
+    std::vector<int> cell_units;
+    // Cells sharing a unit with each cell, `peers_per_cell` per cell
+    std::vector<int> peers;
+    size_t peers_per_cell;
+
+    void Init(size_t n);
+    inline const int* Unit(size_t u) { return &units[u * n]; }
+    void Place(int i, int value);
+    bool Eliminate(int i, uint32_t mask);
+
+    bool HiddenSingle();
+    bool NakedSingle();
+    bool Pointing();
+    bool Claiming();
+    bool NakedPair();
+    bool HiddenPair();
+    bool XWing();
+    bool Apply(Technique technique);
+
+public:
+    Rater();
+    void Rate(Problem& problem, Rating& rating);
+};
+
+// Appends the grade and the count of every technique used, e.g.
+// `3.0 hidden_single=40 naked_pair=2`. Unsolved puzzles end with `guess`.
+void FormatRating(const Rating& rating, std::string& out);
@@ -0,0 +1,82 @@
+#include <cstdio>
+#include "stats.h"
+
+PhaseTime& PhaseTime::operator +=(const PhaseTime& other) {
+    wall += other.wall;
+    cpu += other.cpu;
+    perf += other.perf;
+    return *this;
+}
+
+SolverStats& SolverStats::operator +=(const SolverStats& other) {
+    iterations += other.iterations;
+    restarts += other.restarts;
+    successors += other.successors;
+    evals += other.evals;
+    cache_hits += other.cache_hits;
+    generations += other.generations;
+    mutations += other.mutations;
+    crossovers += other.crossovers;
+    successor_time += other.successor_time;
+    eval_time += other.eval_time;
+    reproduce_time += other.reproduce_time;
+    total_time += other.total_time;
+    return *this;
+}
+
+namespace {
+    void AppendCount(std::string& out, const char* name, size_t value) {
+        char field[64];
+        snprintf(field, sizeof(field), "\"%s\": %zu, ", name, value);
+        out += field;
+    }
+
+    void AppendPhase(std::string& out, const char* name, const PhaseTime& t) {
+        char field[96];
+        snprintf(
+            field, sizeof(field), "\"%s\": {\"wall\": %.6f, \"cpu\": %.6f",
+            name, t.wall, t.cpu
+        );
+        out += field;
+
+        // Only the events that were counted
+        if (t.perf.Any()) {
+            out += ", \"perf\": {";
+            bool first = true;
+            for (size_t e = 0; e < n_perf_events; ++e) {
+                if (!t.perf.valid[e]) continue;
+                snprintf(
+                    field, sizeof(field), "%s\"%s\": %llu",
+                    first ? "" : ", ",
+                    PerfEventName((PerfEvent)e),
+                    (unsigned long long)t.perf.values[e]
+                );
+                out += field;
+                first = false;
+            }
+            out += '}';
+        }
+        out += '}';
+    }
+}
+
+void FormatStats(const SolverStats& stats, std::string& out) {
+    out += '{';
+    AppendCount(out, "iterations", stats.iterations);
+    AppendCount(out, "restarts", stats.restarts);
+    AppendCount(out, "successors", stats.successors);
+    AppendCount(out, "evals", stats.evals);
+    AppendCount(out, "cache_hits", stats.cache_hits);
+    AppendCount(out, "generations", stats.generations);
+    AppendCount(out, "mutations", stats.mutations);
+    AppendCount(out, "crossovers", stats.crossovers);
+    out += "\"phases\": {";
+    AppendPhase(out, "successors", stats.successor_time);
+    out += ", ";
+    AppendPhase(out, "eval", stats.eval_time);
+    out += ", ";
+    AppendPhase(out, "reproduce", stats.reproduce_time);
+    out += ", ";
+    AppendPhase(out, "total", stats.total_time);
+    out += "}}";
+}
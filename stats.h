@@ -0,0 +1,113 @@
+#pragma once
+#include <cstddef>
+#include <ctime>
+#include <chrono>
+#include <string>
+#include "perf.h"
+
+// Build with -DSOLVER_STATS=0 (`make STATS=0`) to compile the counters and
+// phase timers out of the solvers
+#ifndef SOLVER_STATS
+#define SOLVER_STATS 1
+#endif
+
+const bool stats_enabled = SOLVER_STATS != 0;
+
+// Time spent in one solver phase. CPU time is for the whole process, so it
+// includes worker threads and can exceed the wall time. Hardware counts
+// (with `EnablePerfCounters`) are for the threads that ran the phase.
+struct PhaseTime {
+    double wall = 0;
+    double cpu = 0;
+    PerfCounts perf;
+
+    PhaseTime& operator +=(const PhaseTime& other);
+};
+
+// What a solver did, kept in its `Checkpoint`. Counters add up over resumed
+// runs, but aren't saved with the checkpoint.
+struct SolverStats {
+    // Hill climber steps
+    size_t iterations = 0;
+    size_t restarts = 0;
+    size_t successors = 0;
+    // Boards whose conflicts were counted, and evals found in the genetic
+    // memo or the hill climber's visited set instead
+    size_t evals = 0;
+    size_t cache_hits = 0;
+
+    size_t generations = 0;
+    size_t mutations = 0;
+    size_t crossovers = 0;
+
+    // Generating and evaluating a hill climber neighbourhood
+    PhaseTime successor_time;
+    // Evaluating a genetic population
+    PhaseTime eval_time;
+    // Crossover and mutation of a genetic population
+    PhaseTime reproduce_time;
+    PhaseTime total_time;
+
+    SolverStats& operator +=(const SolverStats& other);
+};
+
+// Adds to a counter, or does nothing when stats are compiled out
+inline void Tally(size_t& counter, size_t k = 1) {
+    if (stats_enabled) counter += k;
+}
+
+// Adds the calling thread's hardware counts between construction and `Stop`
+// (or destruction), when perf counters are enabled. Worker threads use it
+// for their share of a phase that `PhaseTimer` times on the main thread.
+class PerfTimer {
+private:
+    PerfCounts& counts;
+    PerfCounts start;
+    bool running;
+public:
+    explicit PerfTimer(PerfCounts& counts)
+        : counts(counts), running(stats_enabled && PerfCountersEnabled()) {
+        if (running) start = ReadPerfCounters();
+    }
+
+    ~PerfTimer() { Stop(); }
+
+    void Stop() {
+        if (!running) return;
+        running = false;
+        counts += PerfDelta(start, ReadPerfCounters());
+    }
+};
+
+// Adds the time between construction and `Stop` (or destruction) to a phase
+class PhaseTimer {
+private:
+    PhaseTime& phase;
+    std::chrono::steady_clock::time_point wall_start;
+    std::clock_t cpu_start;
+    bool running;
+    PerfTimer perf;
+public:
+    explicit PhaseTimer(PhaseTime& phase)
+        : phase(phase), cpu_start(0), running(stats_enabled),
+          perf(phase.perf) {
+        if (!running) return;
+        wall_start = std::chrono::steady_clock::now();
+        cpu_start = std::clock();
+    }
+
+    ~PhaseTimer() { Stop(); }
+
+    void Stop() {
+        if (!running) return;
+        running = false;
+        perf.Stop();
+        phase.wall += std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - wall_start
+        ).count();
+        phase.cpu += (double)(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    }
+};
+
+// Appends the stats as one JSON object, with times in seconds
+void FormatStats(const SolverStats& stats, std::string& out);
@@ -0,0 +1,152 @@
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include "../optional.hpp"
+#include "../lib.h"
+#include "../alloc.h"
+
+namespace {
+    // Allocations made by `f`
+    template<class F>
+    size_t Allocations(F f) {
+        size_t before = AllocationCount();
+        f();
+        return AllocationCount() - before;
+    }
+
+    // Allocations of a genetic run that ends after `generations`
+    size_t GeneticAllocations(
+        Problem& problem,
+        size_t generations,
+        Problem::CrossoverType type,
+        size_t n_threads
+    ) {
+        const size_t size = 64;
+        problem.budget = Budget();
+        problem.budget.max_evals = generations * size;
+        return Allocations([&] () {
+            problem.Genetic(
+                Checkpoint(), size, 0.1, 1000000, 0, type, n_threads
+            );
+        });
+    }
+}
+
+int main() {
+    // The hook sees allocations
+    assert(Allocations([] () { delete new int(1); }) == 1);
+
+    Problem problem("tests/sample9");
+    State a = problem.RandomState();
+    State b = problem.RandomState();
+    State child = a;
+
+    // Evaluating, stepping through successors and crossing over reuse the
+    // states' storage
+    assert(Allocations([&] () {
+        a.eval = tl::nullopt;
+        a.CountConflicts();
+    }) == 0);
+    State succ = a;
+    assert(Allocations([&] () {
+        StateIter iter(&a);
+        while (iter.Successor(succ)) succ.Eval();
+    }) == 0);
+    Problem::CrossoverType types[] = {
+        Problem::CrossoverType::OnePoint,
+        Problem::CrossoverType::NPoint,
+        Problem::CrossoverType::Uniform
+    };
+    for (auto type : types) {
+        problem.Reproduce(a, b, type, child);
+        assert(Allocations([&] () {
+            for (size_t k = 0; k < 100; ++k) {
+                problem.Reproduce(a, b, type, child);
+                problem.Mutate(child);
+                problem.Randomize(child);
+            }
+        }) == 0);
+    }
+
+    // Hill climbing allocates while setting up and returning, but not per
+    // step, so 2000 steps (with many restarts on a 9x9) allocate as much as
+    // 10. Same with the visited set.
+    for (size_t capacity = 0; capacity <= 1024; capacity += 1024) {
+        problem.hill_options.visited_capacity = capacity;
+        size_t few = Allocations([&] () {
+            problem.HillClimber(Checkpoint(), 10);
+        });
+        size_t many = Allocations([&] () {
+            problem.HillClimber(Checkpoint(), 2000);
+        });
+        std::cout <<
+            "hill " << capacity << ": " << few << " / " << many << std::endl;
+        assert(few == many);
+    }
+
+    // Neither do genetic generations, with any crossover, thread count or
+    // hash index
+    for (int hash_index = 0; hash_index <= 1; ++hash_index) {
+        problem.genetic_options.hash_index = hash_index;
+        for (auto type : types) {
+            for (size_t n_threads = 1; n_threads <= 2; ++n_threads) {
+                // Once first, so the problem's buffers are sized
+                GeneticAllocations(problem, 2, type, n_threads);
+                size_t few = GeneticAllocations(problem, 3, type, n_threads);
+                size_t many = GeneticAllocations(
+                    problem, 40, type, n_threads
+                );
+                std::cout <<
+                    "genetic " << hash_index << " " << (int)type << " " <<
+                    n_threads << ": " << few << " / " << many << std::endl;
+                assert(few == many);
+            }
+        }
+    }
+
+    // The population is kept across loads; members must start over from
+    // the new givens, for another size and for the same size. Resuming from
+    // the previous puzzle's checkpoint mustn't seed its boards either.
+    Problem sample9("tests/sample9");
+    const char* boards[] = {
+        "24**\n*3**\n**4*\n**31",
+        "1***\n***4\n*2**\n**3*",
+        nullptr
+    };
+    auto check_board = [&] (State& s) {
+        assert(s.data.size() == problem.fixed.size());
+        for (size_t i = 0; i < s.data.size(); ++i) {
+            assert(!problem.IsFixed(i) || s.data[i] == problem.fixed[i]);
+            assert(s.data[i] >= 1 && s.data[i] <= (int)problem.n);
+        }
+        State fresh = s;
+        fresh.Rehash();
+        assert(fresh.hash == s.hash);
+    };
+    Checkpoint reloaded;
+    for (const char** board = boards; ; ++board) {
+        if (*board) {
+            assert(problem.Load(*board) == ParseStatus::Ok);
+        } else {
+            assert(problem.Load(9, sample9.fixed.data()) == ParseStatus::Ok);
+        }
+        problem.budget = Budget();
+        problem.budget.max_evals = 64;
+        Checkpoint climbed = problem.HillClimber(reloaded, 1);
+        check_board(climbed.best);
+        for (auto& s : climbed.population) check_board(s);
+        Checkpoint stale = reloaded;
+        reloaded = problem.Genetic(
+            Checkpoint(), 64, 0.1, 100, 0, Problem::CrossoverType::Uniform, 2
+        );
+        for (auto& s : reloaded.population) check_board(s);
+        Checkpoint resumed = problem.Genetic(
+            stale, 64, 0.1, 100, 0, Problem::CrossoverType::Uniform, 2
+        );
+        for (auto& s : resumed.population) check_board(s);
+        if (!*board) break;
+    }
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "../optional.hpp"
+#include "../lib.h"
+#include "../archive.h"
+
+static const char* bad_file = "/tmp/TestArchiveBad.sdkb";
+
+static void WriteBytes(const std::string& bytes) {
+    std::ofstream f(bad_file, std::ios::binary);
+    f.write(bytes.data(), bytes.size());
+}
+
+// Whether opening `bytes` as an archive, then reading record `i`, throws
+static bool Rejects(const std::string& bytes, size_t i) {
+    WriteBytes(bytes);
+    try {
+        ArchiveReader archive(bad_file);
+        Problem problem;
+        archive.Read(i, problem);
+    } catch (std::invalid_argument& e) {
+        return true;
+    }
+    return false;
+}
+
+static void PutU64(std::string& bytes, size_t offset, uint64_t x) {
+    for (size_t i = 0; i < 8; ++i) bytes[offset + i] = (x >> (8 * i)) & 0xff;
+}
+
+static uint64_t GetU64(const std::string& bytes, size_t offset) {
+    uint64_t x = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        x |= (uint64_t)(uint8_t)bytes[offset + i] << (8 * i);
+    }
+    return x;
+}
+
+int main() {
+    std::string filenames[] = {
+        "sample4",
+        "sample4_1",
+        "sample4_2",
+        "sample4_3",
+        "sample9",
+        "sample16",
+        "sample25"
+    };
+    const char* archive_file = "/tmp/TestArchive.sdkb";
+
+    // Store each puzzle with a random state as its "solution", so every cell
+    // value is exercised
+    std::vector<Problem> problems;
+    std::vector<State> solutions;
+    for (auto filename : filenames) {
+        problems.push_back(Problem("tests/" + filename));
+    }
+    {
+        ArchiveWriter archive(archive_file);
+        for (auto& problem : problems) {
+            solutions.push_back(problem.RandomState());
+            archive.Write(problem, &solutions.back());
+        }
+    }
+
+    ArchiveReader archive(archive_file);
+    assert(archive.Size() == problems.size());
+
+    // Streaming
+    Problem problem;
+    State solution;
+    size_t i = 0;
+    while (archive.Next(problem, &solution)) {
+        std::cout << filenames[i] << " " << RecordSize(problem.n) << std::endl;
+        assert(problem.n == problems[i].n);
+        assert(problem.fixed == problems[i].fixed);
+        assert(problem.n_fixed == problems[i].n_fixed);
+        assert(solution.data == solutions[i].data);
+        assert(solution.hash == solutions[i].hash);
+        i++;
+    }
+    assert(i == problems.size());
+
+    // Random access, backwards
+    for (size_t j = problems.size(); j-- > 0;) {
+        archive.Read(j, problem, &solution);
+        assert(problem.fixed == problems[j].fixed);
+        assert(solution.data == solutions[j].data);
+    }
+
+    archive.Seek(4);
+    assert(archive.Next(problem));
+    assert(problem.fixed == problems[4].fixed);
+
+    // Damaged archives are rejected rather than read out of bounds
+    std::string bytes;
+    {
+        std::ifstream f(archive_file, std::ios::binary);
+        std::stringstream ss;
+        ss << f.rdbuf();
+        bytes = ss.str();
+    }
+    size_t last = problems.size() - 1;
+    size_t index_offset = bytes.size() - (problems.size() * 8) - 8;
+    assert(!Rejects(bytes, last));
+    for (size_t cut : { (size_t)1, (size_t)8, (size_t)200, bytes.size() - 8 }) {
+        assert(Rejects(bytes.substr(0, bytes.size() - cut), 0));
+    }
+    std::string bad = bytes;
+    PutU64(bad, 8, (uint64_t)1 << 61);
+    assert(Rejects(bad, 0));
+    bad = bytes;
+    PutU64(bad, index_offset + (last * 8), bytes.size());
+    assert(Rejects(bad, last));
+    PutU64(bad, index_offset + (last * 8), (uint64_t)-1);
+    assert(Rejects(bad, last));
+    // The last record is 25x25, so a bigger `n` runs into the index
+    bad = bytes;
+    size_t last_offset = GetU64(bytes, index_offset + (last * 8));
+    bad[last_offset] = 36;
+    assert(Rejects(bad, last));
+    bad[last_offset] = 5;
+    assert(Rejects(bad, last));
+
+    std::cout << "Pass" << std::endl;
+
+    return 0;
+}
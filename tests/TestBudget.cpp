@@ -0,0 +1,123 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include "../optional.hpp"
+#include "../lib.h"
+#include "../exact.h"
+#include "../budget.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double Since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main() {
+    // A past deadline stops at the first check, no limits never do
+    BudgetCheck past(Budget::Within(-1));
+    assert(past.Exhausted(0) && past.stop == BudgetStop::Deadline);
+    Budget none;
+    BudgetCheck unlimited(none);
+    for (size_t i = 0; i < 100000; ++i) assert(!unlimited.Exhausted(i));
+
+    Problem small("tests/sample4");
+    Checkpoint solved = small.HillClimber(Checkpoint());
+    assert(solved.is_goal && solved.stopped == BudgetStop::None);
+
+    // The hill climber can't solve a 9x9, so it runs until the deadline and
+    // returns the best state so far
+    Problem problem("tests/sample9");
+    problem.budget = Budget::Within(0.1);
+    auto start = Clock::now();
+    Checkpoint hill = problem.HillClimber(Checkpoint());
+    double seconds = Since(start);
+    std::cout << "hill stopped after " << seconds << "s" << std::endl;
+    assert(hill.stopped == BudgetStop::Deadline && !hill.is_goal);
+    assert(seconds >= 0.1 && seconds < 0.5);
+    assert(hill.best.problem == &problem && hill.best.Eval() > 0);
+
+    problem.budget = Budget();
+    problem.budget.max_evals = 1000;
+    hill = problem.HillClimber(Checkpoint());
+    assert(hill.stopped == BudgetStop::Evals);
+    if (stats_enabled) {
+        assert(hill.stats.evals == 1000);
+    }
+
+    // Cancelled from another thread
+    std::atomic<bool> cancel(false);
+    problem.budget = Budget();
+    problem.budget.cancel = &cancel;
+    std::thread canceller([&] () {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        cancel = true;
+    });
+    start = Clock::now();
+    Checkpoint genetic = problem.Genetic(
+        Checkpoint(), 100, 0.1, 1000000, 0,
+        Problem::CrossoverType::Uniform, 2
+    );
+    canceller.join();
+    seconds = Since(start);
+    std::cout << "genetic cancelled after " << seconds << "s" << std::endl;
+    assert(genetic.stopped == BudgetStop::Cancelled && !genetic.is_goal);
+    assert(seconds < 1);
+    assert(genetic.best.problem == &problem);
+    assert(genetic.population[0].data == genetic.best.data);
+
+    problem.budget = Budget();
+    problem.budget.max_evals = 300;
+    genetic = problem.Genetic(
+        Checkpoint(), 100, 0.1, 1000000, 0,
+        Problem::CrossoverType::OnePoint, 1
+    );
+    assert(genetic.stopped == BudgetStop::Evals && genetic.iter == 2);
+
+    // The exact search stops too, with no solution
+    for (size_t n_threads = 1; n_threads <= 2; ++n_threads) {
+        problem.budget = Budget();
+        problem.budget.cancel = &cancel;
+        Checkpoint exact = SolveExact(problem, n_threads);
+        assert(exact.stopped == BudgetStop::Cancelled && !exact.is_goal);
+
+        problem.budget = Budget();
+        exact = SolveExact(problem, n_threads);
+        assert(exact.stopped == BudgetStop::None && exact.is_goal);
+    }
+    // Threads share one node count, so a split search stops near
+    // `max_evals` in total rather than per subtree. An empty 25x25 takes
+    // far more nodes than this to fill.
+    Problem large;
+    assert(large.Load(25, std::vector<int>(625, 0).data()) == ParseStatus::Ok);
+    for (size_t n_threads = 1; n_threads <= 4; n_threads *= 2) {
+        large.budget = Budget();
+        large.budget.max_evals = 200;
+        Checkpoint exact = SolveExact(large, n_threads);
+        assert(exact.stopped == BudgetStop::Evals && !exact.is_goal);
+        if (stats_enabled) {
+            assert(exact.stats.evals >= large.budget.max_evals);
+            assert(
+                exact.stats.evals <=
+                large.budget.max_evals + n_threads * ExactSearch::node_batch
+            );
+        }
+    }
+
+    // `CountSolutions` ignores the budget, `CountSolutionsWithin` stops at it
+    problem.budget.cancel = &cancel;
+    assert(CountSolutions(problem) == 1);
+    for (size_t n_threads = 1; n_threads <= 2; ++n_threads) {
+        BudgetStop stopped;
+        CountSolutionsWithin(problem, 2, n_threads, stopped);
+        assert(stopped == BudgetStop::Cancelled);
+        large.budget = Budget();
+        large.budget.max_evals = 200;
+        assert(CountSolutionsWithin(large, 2, n_threads, stopped) == 0);
+        assert(stopped == BudgetStop::Evals);
+    }
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
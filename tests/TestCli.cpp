@@ -0,0 +1,54 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+// Runs a command and returns what it printed on stdout. The stats on stderr
+// are dropped.
+static std::string Run(const std::string& command) {
+    std::string out;
+    FILE* pipe = popen((command + " 2>/dev/null").c_str(), "r");
+    assert(pipe);
+    char buffer[4096];
+    size_t len;
+    while ((len = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        out.append(buffer, len);
+    }
+    assert(pclose(pipe) == 0);
+    return out;
+}
+
+static bool Contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+int main() {
+    // A finished search reports uniqueness
+    std::string out = Run("./TestHarnessExact tests/sample9 2");
+    assert(Contains(out, "Unique solution"));
+    assert(!Contains(out, "Stopped"));
+
+    // An empty 25x25 takes far more than 200 nodes to fill. The exact
+    // harness stops at the budget and reports that, rather than running an
+    // unbudgeted uniqueness count.
+    const char* empty_file = "/tmp/TestCli_empty25";
+    {
+        std::ofstream f(empty_file);
+        f << "25\n";
+        for (size_t row = 0; row < 25; ++row) {
+            f << std::string(25, '*') << "\n";
+        }
+    }
+    for (const char* threads : { "1", "2" }) {
+        out = Run(
+            std::string("./TestHarnessExact --max-evals=200 ") + empty_file +
+            " " + threads
+        );
+        assert(Contains(out, "Stopped: evals"));
+        assert(!Contains(out, "solution"));
+    }
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
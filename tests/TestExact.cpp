@@ -0,0 +1,83 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "../optional.hpp"
+#include "../lib.h"
+#include "../exact.h"
+
+int main() {
+    // Puzzles with a unique solution
+    std::string filenames[] = {
+        "sample4",
+        "sample9"
+    };
+    for (auto filename : filenames) {
+        Problem problem("tests/" + filename);
+        std::vector<int> solution;
+        size_t count = CountSolutions(problem, 2, &solution);
+        std::cout << filename << " " << count << std::endl;
+        assert(count == 1);
+
+        Checkpoint checkpoint = SolveExact(problem, 4);
+        assert(checkpoint.is_goal);
+        assert(checkpoint.best.data == solution);
+        assert(checkpoint.best.Eval() == 0);
+    }
+
+    // `tests/sample16` has several solutions
+    Problem sparse("tests/sample16");
+    assert(CountSolutions(sparse, 2) == 2);
+    assert(CountSolutions(sparse, 2, nullptr, 4) == 2);
+    assert(SolveExact(sparse, 4).best.Eval() == 0);
+
+    // An empty 4x4 board has 288 solutions, with any number of threads
+    Problem empty;
+    assert(empty.Load(4, std::vector<int>(16, 0).data()) == ParseStatus::Ok);
+    for (size_t n_threads = 1; n_threads <= 4; ++n_threads) {
+        size_t count = CountSolutions(empty, 0, nullptr, n_threads);
+        std::cout << "empty4 " << n_threads << " " << count << std::endl;
+        assert(count == 288);
+        assert(CountSolutions(empty, 2, nullptr, n_threads) == 2);
+    }
+
+    // Subtrees: own newest first, stolen oldest first
+    SplitPool pool(2);
+    pool.Give(0, std::vector<int>(1, 1));
+    pool.Give(0, std::vector<int>(1, 2));
+    pool.Give(0, std::vector<int>(1, 3));
+    std::vector<int> part;
+    assert(pool.Take(1, part) && part[0] == 1);
+    assert(pool.Take(0, part) && part[0] == 3);
+    assert(!pool.Hungry());
+    pool.Done();
+    pool.Done();
+    assert(pool.Take(1, part) && part[0] == 2);
+    pool.Done();
+    assert(!pool.Take(0, part) && !pool.Take(1, part));
+
+    // A 9x9 with only its top rows given has many solutions, and threads
+    // splitting their subtrees for each other count each exactly once
+    Problem top("tests/sample9");
+    std::vector<int> cells = top.fixed;
+    std::fill(cells.begin() + 50, cells.end(), 0);
+    assert(top.Load(9, cells.data()) == ParseStatus::Ok);
+    size_t all = CountSolutions(top, 0);
+    std::cout << "top9 " << all << std::endl;
+    assert(all > 100);
+    for (size_t n_threads = 2; n_threads <= 8; n_threads *= 2) {
+        assert(CountSolutions(top, 0, nullptr, n_threads) == all);
+        assert(CountSolutions(top, 100, nullptr, n_threads) == 100);
+    }
+
+    // Conflicting givens have no solution
+    Problem conflict;
+    assert(conflict.Load("11**\n****\n****\n****") == ParseStatus::Ok);
+    assert(CountSolutions(conflict) == 0);
+    assert(!SolveExact(conflict, 2).is_goal);
+
+    std::cout << "Pass" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include "../optional.hpp"
+#include "../lib.h"
+#include "../exact.h"
+#include "../generate.h"
+
+int main() {
+    size_t sizes[] = { 4, 9 };
+    size_t givens[] = { 6, 28 };
+    for (size_t k = 0; k < 2; ++k) {
+        GeneratorOptions options;
+        options.n = sizes[k];
+        options.givens = givens[k];
+        Generator generator(k);
+        Generator same_seed(k);
+
+        for (size_t i = 0; i < 20; ++i) {
+            std::vector<int> puzzle;
+            std::vector<int> solution;
+            assert(generator.Generate(options, puzzle, &solution));
+
+            // Exactly the requested givens, and a unique solution that
+            // agrees with them
+            Problem problem;
+            assert(problem.Load(options.n, puzzle.data()) == ParseStatus::Ok);
+            assert(problem.n_fixed == options.givens);
+            std::vector<int> found;
+            assert(CountSolutions(problem, 2, &found) == 1);
+            assert(found == solution);
+            for (size_t j = 0; j < puzzle.size(); ++j) {
+                assert(puzzle[j] == 0 || puzzle[j] == solution[j]);
+            }
+
+            std::vector<int> again;
+            assert(same_seed.Generate(options, again));
+            assert(again == puzzle);
+        }
+        std::cout << "generated " << sizes[k] << std::endl;
+    }
+
+    // Difficulty band
+    GeneratorOptions options;
+    options.givens = 26;
+    options.min_branches = 2;
+    options.max_branches = 10;
+    Generator generator(1);
+    for (size_t i = 0; i < 5; ++i) {
+        std::vector<int> puzzle;
+        assert(generator.Generate(options, puzzle));
+        size_t branches = generator.Branches();
+        std::cout << "branches " << branches << std::endl;
+        assert(branches >= 2 && branches <= 10);
+    }
+
+    std::cout << "Pass" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <cassert>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include "../optional.hpp"
+#include "../lib.h"
+#include "../trace.h"
+
+// Whether every member keeps the givens
+static bool KeepsGivens(Problem& problem, std::vector<State>& population) {
+    for (auto& s : population) {
+        for (size_t i = 0; i < s.data.size(); ++i) {
+            if (problem.IsFixed(i) && s.data[i] != problem.fixed[i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Runs `Genetic` with a binary trace and returns its records
+static std::vector<GenerationTrace> TracedRun(
+    Problem& problem,
+    double mutate_prob,
+    size_t terminate_streak
+) {
+    std::stringstream binary;
+    {
+        GeneticTrace trace(binary, TraceFormat::Binary);
+        problem.trace = &trace;
+        problem.Genetic(
+            Checkpoint(), 50, mutate_prob, terminate_streak, 0,
+            Problem::CrossoverType::Uniform, 1
+        );
+    }
+    problem.trace = nullptr;
+    std::vector<GenerationTrace> records;
+    assert(ReadBinaryTrace(binary, records));
+    return records;
+}
+
+int main() {
+    SeedRandom(1);
+    Problem problem("tests/sample9");
+
+    // Identical members have no diversity, random ones some
+    State base = problem.RandomState();
+    std::vector<State> population(20, base);
+    assert(problem.Diversity(population, 32) == 0);
+    for (auto& s : population) problem.Randomize(s);
+    double diversity = problem.Diversity(population, 32);
+    std::cout << "diversity " << diversity << std::endl;
+    assert(diversity > 0 && diversity <= 1);
+
+    // Reseeding replaces exactly the fraction asked for, and keeps givens
+    for (double fraction : { 0.0, 0.25, 0.5, 1.0 }) {
+        population.assign(20, base);
+        problem.Reseed(population, fraction);
+        size_t replaced = 0;
+        for (auto& s : population) {
+            replaced += s.data != base.data;
+            State fresh = s;
+            fresh.Rehash();
+            assert(fresh.hash == s.hash);
+        }
+        assert(replaced == (size_t)(fraction * population.size()));
+        assert(KeepsGivens(problem, population));
+    }
+
+    // The mutation rate is boosted every generation while diversity is low
+    // (always, here), up to `mutate_max`, but never capped below the base
+    // rate
+    problem.genetic_options.diversity_low = 2;
+    problem.budget.max_evals = 50 * 20;
+    std::vector<GenerationTrace> records = TracedRun(problem, 0.1, 1000);
+    assert(records.size() == 20);
+    for (auto& r : records) {
+        assert(r.mutate_rate >= 0.1);
+        assert(r.mutate_rate <= problem.genetic_options.mutate_max);
+    }
+    assert(records.back().mutate_rate == problem.genetic_options.mutate_max);
+    records = TracedRun(problem, 0.8, 1000);
+    for (auto& r : records) assert(r.mutate_rate == 0.8);
+    problem.genetic_options = GeneticOptions();
+
+    // After each reseed the best state so far is put back, so the next
+    // generation is at least as good as any before it
+    problem.budget = Budget();
+    problem.genetic_options.max_restarts = 5;
+    records = TracedRun(problem, 0.1, 3);
+    assert(records.back().restarts == 5);
+    int64_t best = records[0].best;
+    for (size_t i = 1; i < records.size(); ++i) {
+        if (records[i].restarts > records[i - 1].restarts) {
+            assert(records[i].best >= best);
+        }
+        best = std::max(best, records[i].best);
+    }
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
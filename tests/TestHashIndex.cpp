@@ -0,0 +1,104 @@
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "../optional.hpp"
+#include "../lib.h"
+
+// Spread out like Zobrist hashes: the low 12 bits of the first 4096 keys are
+// all different
+static uint64_t Key(size_t i) {
+    return (i + 1) * 0x9E3779B97F4A7C15ull;
+}
+
+static int Value(size_t i) {
+    return (int)(i % 1000);
+}
+
+int main() {
+    // Capacity rounds up to a power of 2
+    HashIndex index(100);
+    assert(index.Capacity() == 128 && index.Size() == 0);
+
+    // Insert then find
+    int value = -1;
+    assert(!index.Find(5, value));
+    assert(index.Insert(5, 10));
+    assert(index.Find(5, value) && value == 10);
+    assert(index.Size() == 1);
+
+    // A duplicate returns false, and updates the value unless it is pending
+    assert(!index.Insert(5, 11));
+    assert(index.Find(5, value) && value == 11);
+    assert(!index.Insert(5));
+    assert(index.Find(5, value) && value == 11);
+    assert(index.Size() == 1);
+
+    // A pending key is claimed but not found until its value is set
+    assert(index.Insert(6));
+    assert(!index.Find(6, value));
+    assert(!index.Insert(6, 4));
+    assert(index.Find(6, value) && value == 4);
+
+    // 0 marks an empty slot, but still works as a key
+    assert(index.Insert(0, 3));
+    assert(index.Find(0, value) && value == 3);
+    assert(index.lookups > 0 && index.hits > 0 && index.hits <= index.lookups);
+
+    // Clear empties every slot
+    index.Clear();
+    assert(index.Size() == 0);
+    assert(!index.Find(5, value) && !index.Find(6, value));
+    assert(index.Insert(5, 7));
+    assert(index.Find(5, value) && value == 7);
+
+    // Keys that start at the same slot take the next ones, up to 16 probes.
+    // Past that a key is reported as new but not stored.
+    HashIndex full(64);
+    for (uint64_t j = 0; j < 16; ++j) {
+        assert(full.Insert(8 + (j * 64), (int)j));
+    }
+    assert(full.Size() == 16);
+    assert(full.Insert(8 + (16 * 64), 16));
+    assert(full.Size() == 16);
+    assert(!full.Find(8 + (16 * 64), value));
+    for (uint64_t j = 0; j < 16; ++j) {
+        assert(full.Find(8 + (j * 64), value) && value == (int)j);
+    }
+
+    // Two threads claim the same keys as the genetic memo does: whoever
+    // inserts a key first sets its value. Each key is claimed exactly once,
+    // and a key is never found while it is still pending.
+    const size_t n_keys = 1000;
+    HashIndex shared(4096);
+    std::atomic<size_t> claimed(0);
+    std::atomic<bool> seen_pending(false);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 2; ++t) {
+        threads.push_back(std::thread([&, t] () {
+            for (size_t k = 0; k < n_keys; ++k) {
+                // The threads walk the keys in opposite orders so they meet
+                // in the middle
+                size_t i = t == 0 ? k : n_keys - 1 - k;
+                int found;
+                if (shared.Find(Key(i), found) && found != Value(i)) {
+                    seen_pending = true;
+                }
+                if (shared.Insert(Key(i))) {
+                    claimed++;
+                    shared.Insert(Key(i), Value(i));
+                }
+            }
+        }));
+    }
+    for (auto& t : threads) t.join();
+    assert(!seen_pending);
+    assert(claimed == n_keys && shared.Size() == n_keys);
+    for (size_t i = 0; i < n_keys; ++i) {
+        assert(shared.Find(Key(i), value) && value == Value(i));
+    }
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include "../optional.hpp"
+#include "../lib.h"
+#include "../exact.h"
+#include "../generate.h"
+#include "../multi.h"
+
+int main() {
+    MultiSolver solver;
+    std::vector<int> solutions[multi_lanes];
+    std::vector<bool> solved(multi_lanes);
+
+    // Unique puzzles from easy to hard, in every lane; each must match its
+    // only solution whether propagation finishes it or not
+    Generator generator(3);
+    size_t givens[] = { 40, 30, 24, 22 };
+    for (size_t g : givens) {
+        GeneratorOptions options;
+        options.givens = g;
+        std::vector<Problem> problems(multi_lanes);
+        std::vector<std::vector<int>> expected(multi_lanes);
+        for (size_t l = 0; l < multi_lanes; ++l) {
+            std::vector<int> puzzle;
+            assert(generator.Generate(options, puzzle, &expected[l]));
+            assert(problems[l].Load(9, puzzle.data()) == ParseStatus::Ok);
+        }
+        size_t n_solved = solver.Solve(
+            problems.data(), multi_lanes, solutions, solved
+        );
+        std::cout <<
+            "givens " << g << ": " << solver.propagated <<
+            " propagated in " << solver.passes << " passes" << std::endl;
+        assert(n_solved == multi_lanes);
+        for (size_t l = 0; l < multi_lanes; ++l) {
+            assert(solved[l] && solutions[l] == expected[l]);
+        }
+    }
+
+    // A partial group with another size, a contradiction and an empty board
+    std::vector<Problem> problems(4);
+    problems[0] = Problem("tests/sample9");
+    problems[1] = Problem("tests/sample4");
+    assert(problems[2].Load(std::string(81, '.')) == ParseStatus::Ok);
+    std::string conflict = std::string(81, '.');
+    conflict[0] = conflict[1] = '5';
+    assert(problems[3].Load(conflict) == ParseStatus::Ok);
+    assert(solver.Solve(problems.data(), 4, solutions, solved) == 3);
+    assert(solved[0] && solved[1] && solved[2] && !solved[3]);
+    for (size_t l = 0; l < 3; ++l) {
+        State state(&problems[l]);
+        for (size_t i = 0; i < state.data.size(); ++i) {
+            assert(!problems[l].IsFixed(i) ||
+                solutions[l][i] == problems[l].fixed[i]);
+            state.Set(i, solutions[l][i]);
+        }
+        assert(state.Eval() == 0);
+    }
+
+    std::cout << "Pass" << std::endl;
+
+    return 0;
+}
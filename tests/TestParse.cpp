@@ -0,0 +1,127 @@
+#include <iostream>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include "../optional.hpp"
+#include "../lib.h"
+#include "../parse.h"
+
+bool Throws(std::string text) {
+    size_t n;
+    try {
+        ParseBoard(text, n);
+    } catch (std::invalid_argument& e) {
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    // The same puzzle in every format
+    Problem expected("tests/sample9");
+    std::string filenames[] = {
+        "sample9_line",
+        "sample9_csv"
+    };
+    for (auto filename : filenames) {
+        Problem problem("tests/" + filename);
+        std::cout << filename << std::endl;
+        assert(problem.n == expected.n);
+        assert(problem.fixed == expected.fixed);
+        assert(problem.n_fixed == expected.n_fixed);
+    }
+
+    // Letter-encoded boards
+    size_t sizes[] = { 16, 25 };
+    for (size_t n : sizes) {
+        Problem problem("tests/sample" + std::to_string(n));
+        std::cout << "sample" << n << std::endl;
+        assert(problem.n == n);
+        for (int x : problem.fixed) {
+            assert(x >= 0 && x <= (int)n);
+        }
+    }
+
+    // A solved 16x16 board, one line of letters
+    std::string solved;
+    for (size_t row = 0; row < 16; ++row) {
+        for (size_t col = 0; col < 16; ++col) {
+            size_t value = ((4 * (row % 4)) + (row / 4) + col) % 16;
+            solved += 'A' + value;
+        }
+    }
+    size_t n;
+    Problem problem("tests/sample16");
+    problem.Init(16, ParseBoard(solved, n));
+    assert(n == 16);
+    State state = problem.RandomState();
+    std::cout << "solved16 " << state.Eval() << std::endl;
+    assert(state.Eval() == 0);
+
+    // Multi-digit cells
+    std::string tokens;
+    for (char c : solved) {
+        tokens += std::to_string(c - 'A' + 1) + " ";
+    }
+    assert(ParseBoard(tokens, n) == ParseBoard(solved, n));
+
+    // Single-line fast path agrees with ParseBoard
+    std::string lines[] = {
+        solved,
+        tokens,
+        "2...87..551..9.76..37...92.64.82..5..2..5...63.5.692841..9..67......5.3..82..1..9\r",
+        "2...87..551..9.76..",
+        "2...87..551..9.76...37...92.64.82..5..2..5...63.5.692841..9..67.."
+    };
+    for (auto line : lines) {
+        std::vector<int> cells;
+        size_t line_n;
+        const char* begin = line.data();
+        bool ok = ParseLine(
+            begin, begin + line.size(), line_n, cells
+        ) == ParseStatus::Ok;
+        std::cout << "line " << ok << std::endl;
+        assert(ok == !Throws(line));
+        if (ok) assert(cells == ParseBoard(line, n) && line_n == n);
+    }
+
+    // Malformed input
+    assert(Throws(""));
+    assert(Throws("12345"));
+    assert(Throws("4\n12*\n****\n****\n****"));
+    assert(Throws("4\n1234\n****\n****"));
+    assert(Throws("4\n12A*\n****\n****\n****"));
+    assert(Throws("4\n1,2,3,9\n*,*,*,*\n*,*,*,*\n*,*,*,*"));
+    assert(Throws("1,2,3"));
+
+    // Loading from memory
+    std::string rows = "4\n1*3*\n****\n****\n***4\n";
+    Problem loaded;
+    assert(loaded.Load(rows) == ParseStatus::Ok);
+    assert(loaded.n == 4 && loaded.n_fixed == 3);
+    std::vector<int> raw = loaded.fixed;
+    assert(loaded.Load(lines[2]) == ParseStatus::Ok);
+    assert(loaded.fixed == ParseBoard(lines[2], n) && loaded.n == 9);
+    assert(loaded.Load(4, raw.data()) == ParseStatus::Ok);
+    assert(loaded.fixed == raw && loaded.n == 4);
+
+    // Malformed input is reported without throwing, and leaves the problem
+    // as it was
+    raw[0] = 5;
+    assert(loaded.Load(4, raw.data()) == ParseStatus::OutOfRange);
+    assert(loaded.Load(3, raw.data()) == ParseStatus::NotSquare);
+    std::vector<int> big(36 * 36, 0);
+    assert(loaded.Load(36, big.data()) == ParseStatus::TooLarge);
+    std::string big_line = "0";
+    for (size_t i = 1; i < big.size(); ++i) big_line += ",0";
+    assert(loaded.Load(big_line) == ParseStatus::TooLarge);
+    assert(loaded.Load("") == ParseStatus::Empty);
+    assert(loaded.Load("4\n12A*\n****\n****\n****") == ParseStatus::BadCell);
+    assert(loaded.Load("4\n1234\n****\n****") == ParseStatus::RowCount);
+    assert(loaded.Load("4\n12*\n****\n****\n****") == ParseStatus::RowLength);
+    assert(loaded.n == 4 && loaded.fixed[0] == 1);
+
+    std::cout << "Pass" << std::endl;
+
+    return 0;
+}
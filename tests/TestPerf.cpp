@@ -0,0 +1,69 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include "../optional.hpp"
+#include "../lib.h"
+#include "../stats.h"
+#include "../perf.h"
+
+int main() {
+    // Deltas are only valid where both reads are, sums where either is
+    PerfCounts a;
+    PerfCounts b;
+    a.values[0] = 10;
+    a.valid[0] = true;
+    b.values[0] = 25;
+    b.valid[0] = true;
+    b.values[1] = 7;
+    b.valid[1] = true;
+    PerfCounts delta = PerfDelta(a, b);
+    assert(delta.Valid(PerfEvent::Cycles));
+    assert(delta.Get(PerfEvent::Cycles) == 15);
+    assert(!delta.Valid(PerfEvent::Instructions));
+    a += b;
+    assert(a.Get(PerfEvent::Cycles) == 35 && a.Valid(PerfEvent::Instructions));
+    assert(!PerfCounts().Any() && a.Any());
+
+    // Off by default: no counts, and the stats look as before
+    assert(!PerfCountersEnabled() && !ReadPerfCounters().Any());
+    Problem problem("tests/sample4");
+    Checkpoint hill = problem.HillClimber(Checkpoint());
+    assert(!hill.stats.successor_time.perf.Any());
+    std::string json;
+    FormatStats(hill.stats, json);
+    assert(json.find("perf") == std::string::npos);
+
+    // Enabled, phases carry whatever counters the machine allows, or none;
+    // the solvers work the same either way
+    EnablePerfCounters();
+    bool available = PerfCountersAvailable();
+    std::cout << "counters " << (available ? "available" : "unavailable") <<
+        std::endl;
+    assert(available == ReadPerfCounters().Any());
+
+    hill = problem.HillClimber(Checkpoint());
+    assert(hill.is_goal);
+    Checkpoint genetic = problem.Genetic(
+        Checkpoint(), 100, 0.1, 100, 0, Problem::CrossoverType::Uniform, 2
+    );
+    const SolverStats& h = hill.stats;
+    const SolverStats& g = genetic.stats;
+    bool counted = available && stats_enabled;
+    assert(h.successor_time.perf.Any() == counted);
+    // Counted on the worker threads
+    assert(g.eval_time.perf.Any() == counted);
+    if (counted && h.successor_time.perf.Valid(PerfEvent::Instructions)) {
+        assert(h.successor_time.perf.Get(PerfEvent::Instructions) > 0);
+    }
+
+    json.clear();
+    FormatStats(h, json);
+    std::cout << json << std::endl;
+    assert((json.find("\"perf\": {") != std::string::npos) == counted);
+
+    EnablePerfCounters(false);
+    assert(!ReadPerfCounters().Any());
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <vector>
+#include "../optional.hpp"
+#include "../lib.h"
+#include "../portfolio.h"
+
+int main() {
+    // Extra threads follow the wins; without wins they are spread evenly
+    PortfolioOptions options;
+    options.n_threads = 6;
+    Portfolio portfolio(options);
+    size_t threads[n_portfolio_engines];
+    portfolio.Allocate(threads);
+    for (size_t e = 0; e < n_portfolio_engines; ++e) assert(threads[e] == 2);
+
+    // The hill climber can't solve a 9x9 and the genetic algorithm rarely
+    // does, so the exact search wins
+    Problem problem("tests/sample9");
+    for (size_t k = 0; k < 3; ++k) {
+        PortfolioEngine winner;
+        Checkpoint checkpoint = portfolio.Solve(problem, &winner);
+        assert(checkpoint.is_goal && checkpoint.best.IsGoal());
+        assert(checkpoint.best.problem == &problem);
+        assert(checkpoint.stopped == BudgetStop::None);
+        assert(winner == PortfolioEngine::Exact);
+    }
+    assert(portfolio.Runs() == 3);
+    assert(portfolio.Wins(PortfolioEngine::Exact) == 3);
+    portfolio.Allocate(threads);
+    // Weights 4:1:1 for 3 extra threads; the tie for the last one goes to
+    // the first engine
+    assert(threads[(size_t)PortfolioEngine::Exact] == 3);
+    assert(threads[(size_t)PortfolioEngine::HillClimber] == 2);
+    size_t total = 0;
+    for (size_t e = 0; e < n_portfolio_engines; ++e) total += threads[e];
+    assert(total == options.n_threads);
+
+    // Someone wins on a 4x4, and the result belongs to the caller's problem
+    Problem small("tests/sample4");
+    Checkpoint checkpoint = portfolio.Solve(small);
+    assert(checkpoint.is_goal && checkpoint.best.problem == &small);
+    size_t wins = 0;
+    for (size_t e = 0; e < n_portfolio_engines; ++e) {
+        wins += portfolio.Wins((PortfolioEngine)e);
+    }
+    assert(wins == 4 && portfolio.Runs() == 4);
+
+    // No solution: the exact search proves it and ends the race
+    std::vector<int> cells(16, 0);
+    cells[0] = 1;
+    cells[1] = 1;
+    Problem conflict;
+    assert(conflict.Load(4, cells.data()) == ParseStatus::Ok);
+    PortfolioEngine winner;
+    checkpoint = portfolio.Solve(conflict, &winner);
+    assert(!checkpoint.is_goal && winner == PortfolioEngine::Exact);
+
+    // An external cancel stops every engine, and nobody wins
+    std::atomic<bool> cancel(true);
+    problem.budget.cancel = &cancel;
+    checkpoint = portfolio.Solve(problem, &winner);
+    assert(!checkpoint.is_goal && winner == PortfolioEngine::Count);
+    assert(checkpoint.stopped == BudgetStop::Cancelled);
+    assert(checkpoint.best.problem == &problem);
+    assert(portfolio.Runs() == 6);
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
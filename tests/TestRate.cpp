@@ -0,0 +1,64 @@
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include "../optional.hpp"
+#include "../lib.h"
+#include "../exact.h"
+#include "../generate.h"
+#include "../rate.h"
+
+int main() {
+    Rater rater;
+    Rating rating;
+
+    // Needs nothing but hidden singles
+    Problem problem("tests/sample9");
+    rater.Rate(problem, rating);
+    std::vector<int> solution;
+    CountSolutions(problem, 1, &solution);
+    assert(rating.solved && rating.board == solution);
+    assert(rating.grade == TechniqueWeight(Technique::HiddenSingle));
+    std::cout << "sample9 " << rating.grade << std::endl;
+
+    // Every technique must be sound: whenever a generated puzzle is solved,
+    // it's solved to its unique solution
+    GeneratorOptions options;
+    options.givens = 24;
+    Generator generator(7);
+    size_t used[n_techniques] = {};
+    size_t guesses = 0;
+    for (size_t i = 0; i < 300; ++i) {
+        std::vector<int> puzzle;
+        assert(generator.Generate(options, puzzle, &solution));
+        assert(problem.Load(9, puzzle.data()) == ParseStatus::Ok);
+        rater.Rate(problem, rating);
+        for (size_t j = 0; j < puzzle.size(); ++j) {
+            assert(rating.board[j] == 0 || rating.board[j] == solution[j]);
+        }
+        if (!rating.solved) {
+            guesses++;
+            assert(rating.grade == guess_weight);
+        }
+        for (size_t t = 0; t < n_techniques; ++t) {
+            if (rating.steps[t] > 0) used[t]++;
+        }
+    }
+    for (size_t t = 0; t < n_techniques; ++t) {
+        std::cout << TechniqueName((Technique)t) << " " << used[t] << std::endl;
+    }
+    std::cout << "guess " << guesses << std::endl;
+    assert(used[(size_t)Technique::NakedPair] > 0);
+    assert(used[(size_t)Technique::Pointing] > 0);
+
+    // An empty board needs guessing, conflicting givens never finish
+    assert(problem.Load(4, std::vector<int>(16, 0).data()) == ParseStatus::Ok);
+    rater.Rate(problem, rating);
+    assert(!rating.solved && rating.grade == guess_weight);
+    assert(problem.Load("11**\n****\n****\n****") == ParseStatus::Ok);
+    rater.Rate(problem, rating);
+    assert(!rating.solved);
+
+    std::cout << "Pass" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include "../optional.hpp"
+#include "../lib.h"
+#include "../exact.h"
+#include "../stats.h"
+
+int main() {
+    Problem problem("tests/sample4");
+
+    // Hill climber: one neighbourhood per step, all of it evaluated
+    Checkpoint hill = problem.HillClimber(Checkpoint());
+    assert(hill.is_goal);
+    const SolverStats& h = hill.stats;
+    if (stats_enabled) {
+        assert(h.iterations == hill.iter);
+        assert(h.restarts == hill.restarts);
+        assert(h.successors > 0);
+        assert(h.evals == h.successors + h.restarts);
+        assert(h.generations == 0 && h.crossovers == 0);
+        assert(h.total_time.wall > 0);
+        assert(h.successor_time.wall <= h.total_time.wall);
+    } else {
+        assert(h.iterations == 0 && h.successors == 0);
+    }
+
+    // Resuming adds to the counters
+    Checkpoint resumed = problem.HillClimber(hill, 5);
+    if (stats_enabled) {
+        size_t steps = resumed.iter - hill.iter;
+        assert(resumed.stats.iterations == h.iterations + steps);
+    }
+
+    // Restarts carry over too, without counting the earlier ones twice
+    Problem sample9("tests/sample9");
+    Checkpoint climbing = sample9.HillClimber(Checkpoint(), 300);
+    assert(!climbing.is_goal && climbing.restarts > 0);
+    Checkpoint climbed = sample9.HillClimber(climbing, 300);
+    assert(climbed.restarts >= climbing.restarts);
+    if (stats_enabled) {
+        assert(climbed.stats.restarts == climbed.restarts);
+    }
+    sample9.genetic_options.max_restarts = 2;
+    Checkpoint reseeded = sample9.Genetic(
+        Checkpoint(), 50, 0.1, 3, 0, Problem::CrossoverType::Uniform, 1
+    );
+    assert(reseeded.is_goal || reseeded.restarts == 2);
+    Checkpoint resumed_genetic = sample9.Genetic(
+        reseeded, 50, 0.1, 3, 0, Problem::CrossoverType::Uniform, 1
+    );
+    // `max_restarts` applies per call
+    assert(resumed_genetic.is_goal || resumed_genetic.restarts == 4);
+    if (stats_enabled) {
+        assert(resumed_genetic.stats.restarts == resumed_genetic.restarts);
+    }
+
+    // Genetic: one child per member each generation but the last, split
+    // across threads
+    size_t size = 100;
+    Checkpoint genetic = problem.Genetic(
+        Checkpoint(), size, 0.1, 100, 0, Problem::CrossoverType::Uniform, 2
+    );
+    const SolverStats& g = genetic.stats;
+    if (stats_enabled) {
+        assert(g.generations == genetic.iter + 1);
+        assert(g.crossovers == (g.generations - 1) * size);
+        assert(g.evals > 0 && g.evals <= g.generations * size);
+        assert(g.iterations == 0 && g.successors == 0);
+        assert(g.eval_time.wall > 0);
+        assert(g.generations == 1 || g.reproduce_time.wall > 0);
+    } else {
+        assert(g.generations == 0 && g.crossovers == 0);
+    }
+
+    // The memo turns repeated boards into cache hits
+    problem.genetic_options.hash_index = true;
+    Checkpoint memoised = problem.Genetic(
+        Checkpoint(), size, 0.1, 100, 0, Problem::CrossoverType::Uniform, 1
+    );
+    if (stats_enabled) {
+        const SolverStats& m = memoised.stats;
+        assert(m.evals + m.cache_hits <= m.generations * size);
+    }
+
+    Checkpoint exact = SolveExact(sample9);
+    assert(exact.is_goal);
+    assert(!stats_enabled || exact.stats.total_time.wall > 0);
+
+    SolverStats sum = h;
+    sum += g;
+    if (stats_enabled) {
+        assert(sum.iterations == h.iterations);
+        assert(sum.crossovers == g.crossovers);
+    }
+
+    std::string json;
+    FormatStats(h, json);
+    std::cout << json << std::endl;
+    assert(json.front() == '{' && json.back() == '}');
+    assert(json.find(
+        "\"iterations\": " + std::to_string(h.iterations) + ","
+    ) != std::string::npos);
+    assert(json.find("\"phases\": {\"successors\": {\"wall\": ") !=
+        std::string::npos);
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
@@ -28,6 +28,12 @@ int main() {
                 auto succ_opt = iter.Successor();
                 if (!succ_opt) break;
                 auto succ = *succ_opt;
+
+                // Incremental Zobrist hash matches a full recompute
+                State rehashed = succ;
+                rehashed.Rehash();
+                assert(rehashed.hash == succ.hash);
+
                 assert(succs.count(succ) == 0);
                 succs.insert(succ);
             }
@@ -0,0 +1,72 @@
+#include <iostream>
+#include <cassert>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../optional.hpp"
+#include "../lib.h"
+#include "../trace.h"
+
+int main() {
+    // One record per generation, in order, with sane values
+    Problem problem("tests/sample4");
+    problem.genetic_options.hash_index = true;
+    std::stringstream binary;
+    Checkpoint checkpoint;
+    {
+        GeneticTrace trace(binary, TraceFormat::Binary, 4);
+        problem.trace = &trace;
+        SeedRandom(3);
+        checkpoint = problem.Genetic(
+            Checkpoint(), 50, 0.1, 20, 0, Problem::CrossoverType::Uniform, 2
+        );
+        trace.Flush();
+        assert(trace.Written() == checkpoint.iter + 1);
+    }
+
+    std::vector<GenerationTrace> records;
+    assert(ReadBinaryTrace(binary, records));
+    std::cout << records.size() << " generations" << std::endl;
+    assert(records.size() == checkpoint.iter + 1);
+    for (size_t i = 0; i < records.size(); ++i) {
+        GenerationTrace& r = records[i];
+        assert(r.iter == i);
+        assert(r.worst <= r.mean && r.mean <= r.best);
+        assert(r.best <= problem.GoalEvalGenetic());
+        assert(r.eval_time >= 0 && r.reproduce_time >= 0);
+        assert(r.utilisation >= 0 && r.utilisation <= 1);
+        assert(r.cache_hit_ratio >= 0 && r.cache_hit_ratio <= 1);
+        assert(r.mutate_rate >= 0.1);
+    }
+    assert(records.back().best == problem.GoalEvalGenetic());
+    // The last generation reaches the goal before reproducing
+    assert(records.back().reproduce_time == 0);
+
+    // As CSV: a header and one line per generation. (Runs with the hash
+    // index don't repeat, since threads share it.)
+    std::stringstream csv;
+    {
+        GeneticTrace trace(csv);
+        problem.trace = &trace;
+        checkpoint = problem.Genetic(
+            Checkpoint(), 50, 0.1, 20, 0, Problem::CrossoverType::Uniform, 2
+        );
+    }
+    problem.trace = nullptr;
+    std::string line;
+    std::getline(csv, line);
+    assert(line.compare(0, 19, "iter,restarts,best,") == 0);
+    size_t lines = 0;
+    while (std::getline(csv, line)) {
+        assert(line.compare(0, line.find(','), std::to_string(lines)) == 0);
+        lines++;
+    }
+    assert(lines == checkpoint.iter + 1);
+
+    // Not a binary trace
+    std::stringstream text("iter,restarts\n");
+    assert(!ReadBinaryTrace(text, records));
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <vector>
+#include "../optional.hpp"
+#include "../lib.h"
+#include "../tts.h"
+
+int main() {
+    // Nearest rank
+    std::vector<double> values = { 5, 1, 4, 2, 3 };
+    assert(Quantile(values, 0) == 1);
+    assert(Quantile(values, 0.5) == 3);
+    assert(Quantile(values, 0.9) == 5);
+    assert(Quantile(values, 1) == 5);
+    assert(Quantile(std::vector<double>(), 0.5) == 0);
+
+    // The same seed repeats a run, also with genetic worker threads
+    Problem problem("tests/sample4");
+    SeedRandom(7);
+    Checkpoint a = problem.HillClimber(Checkpoint());
+    SeedRandom(7);
+    Checkpoint b = problem.HillClimber(Checkpoint());
+    assert(a.iter == b.iter && a.restarts == b.restarts);
+    assert(a.best.data == b.best.data);
+
+    for (size_t n_threads = 1; n_threads <= 2; ++n_threads) {
+        SeedRandom(7);
+        Checkpoint c = problem.Genetic(
+            Checkpoint(), 50, 0.1, 50, 0, Problem::CrossoverType::OnePoint,
+            n_threads
+        );
+        SeedRandom(7);
+        Checkpoint d = problem.Genetic(
+            Checkpoint(), 50, 0.1, 50, 0, Problem::CrossoverType::OnePoint,
+            n_threads
+        );
+        assert(c.iter == d.iter && c.best.data == d.best.data);
+    }
+
+    // Every default engine solves a 4x4 within the budget
+    TtsOptions options;
+    options.runs = 3;
+    options.population = 100;
+    std::vector<TtsEngine> engines = DefaultEngines(options);
+    assert(engines.size() == 6);
+    std::vector<TtsRun> runs = MeasureTts(
+        engines, problem, "sample4", options
+    );
+    assert(runs.size() == engines.size() * options.runs);
+    for (auto& run : runs) {
+        assert(run.puzzle == "sample4");
+        assert(run.seed == options.seed + run.run);
+        assert(run.solved && run.seconds <= options.budget);
+        assert(
+            run.engine == "exact" || run.engine == "portfolio" ||
+            run.evals > 0
+        );
+    }
+
+    // Measuring again with the same seeds takes the same number of evals,
+    // except for the portfolio, whose race isn't seeded
+    std::vector<TtsRun> again = MeasureTts(
+        engines, problem, "sample4", options
+    );
+    for (size_t i = 0; i < runs.size(); ++i) {
+        if (runs[i].engine == "portfolio") continue;
+        assert(runs[i].evals == again[i].evals);
+    }
+
+    // Out of budget counts as unsolved, and pushes quantiles to infinity
+    TtsRun late = RunOnce(engines[0], problem, 1, 0);
+    assert(!late.solved);
+
+    std::vector<TtsRun> mixed(4);
+    for (size_t k = 0; k < mixed.size(); ++k) {
+        mixed[k].engine = "e";
+        mixed[k].puzzle = "p";
+        mixed[k].solved = k < 3;
+        mixed[k].seconds = k + 1;
+        mixed[k].evals = 10 * (k + 1);
+    }
+    std::vector<TtsSummary> summaries = SummarizeTts(mixed);
+    assert(summaries.size() == 1);
+    assert(summaries[0].runs == 4 && summaries[0].solved == 3);
+    assert(summaries[0].SuccessRate() == 0.75);
+    assert(summaries[0].median == 2 && summaries[0].median_evals == 20);
+    assert(std::isinf(summaries[0].p90) && std::isinf(summaries[0].p99));
+
+    std::ostringstream csv;
+    WriteSummaryCsv(summaries, csv);
+    assert(csv.str() ==
+        "engine,puzzle,runs,solved,success_rate,median_s,p90_s,p99_s,"
+        "median_evals,p90_evals\n"
+        "e,p,4,3,0.75,2,inf,inf,20,inf\n");
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
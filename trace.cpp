@@ -0,0 +1,145 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <algorithm>
+#include "trace.h"
+
+GeneticTrace::GeneticTrace(
+    std::ostream& out,
+    TraceFormat format,
+    size_t batch_size
+) :
+    out(out),
+    format(format),
+    batch_size(batch_size > 0 ? batch_size : 1),
+    writing(false),
+    stopping(false),
+    written(0) {
+    batch.reserve(this->batch_size);
+    if (format == TraceFormat::Binary) {
+        uint64_t record_size = sizeof(GenerationTrace);
+        out.write(trace_magic, sizeof(trace_magic));
+        out.write((const char*)&record_size, sizeof(record_size));
+    } else {
+        out <<
+            "iter,restarts,best,worst,mean,diversity,mutate_rate,eval_s,"
+            "reproduce_s,utilisation,cache_hit_ratio\n";
+    }
+    writer = std::thread(&GeneticTrace::Run, this);
+}
+
+GeneticTrace::~GeneticTrace() {
+    Hand();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready_cv.notify_one();
+    writer.join();
+    out.flush();
+}
+
+void GeneticTrace::Record(const GenerationTrace& record) {
+    batch.push_back(record);
+    if (batch.size() >= batch_size) Hand();
+}
+
+void GeneticTrace::Hand() {
+    if (batch.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.push_back(std::move(batch));
+    }
+    ready_cv.notify_one();
+    batch = std::vector<GenerationTrace>();
+    batch.reserve(batch_size);
+}
+
+void GeneticTrace::Flush() {
+    Hand();
+    std::unique_lock<std::mutex> lock(mutex);
+    written_cv.wait(lock, [this] () { return ready.empty() && !writing; });
+    out.flush();
+}
+
+size_t GeneticTrace::Written() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return written;
+}
+
+void GeneticTrace::Write(const std::vector<GenerationTrace>& records) {
+    if (format == TraceFormat::Binary) {
+        out.write(
+            (const char*)records.data(),
+            records.size() * sizeof(GenerationTrace)
+        );
+        return;
+    }
+
+    std::string text;
+    char line[320];
+    for (auto& r : records) {
+        int len = snprintf(
+            line, sizeof(line),
+            "%llu,%llu,%lld,%lld,%.3f,%.4f,%.4f,%.6f,%.6f,%.3f,%.3f\n",
+            (unsigned long long)r.iter,
+            (unsigned long long)r.restarts,
+            (long long)r.best,
+            (long long)r.worst,
+            r.mean,
+            r.diversity,
+            r.mutate_rate,
+            r.eval_time,
+            r.reproduce_time,
+            r.utilisation,
+            r.cache_hit_ratio
+        );
+        if (len > 0) {
+            text.append(line, std::min((size_t)len, sizeof(line) - 1));
+        }
+    }
+    out.write(text.data(), text.size());
+}
+
+void GeneticTrace::Run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        ready_cv.wait(lock, [this] () { return !ready.empty() || stopping; });
+        if (ready.empty()) break;
+
+        std::vector<std::vector<GenerationTrace>> batches;
+        batches.swap(ready);
+        writing = true;
+        lock.unlock();
+        size_t n_records = 0;
+        for (auto& records : batches) {
+            Write(records);
+            n_records += records.size();
+        }
+        lock.lock();
+        writing = false;
+        written += n_records;
+        written_cv.notify_all();
+    }
+}
+
+bool ReadBinaryTrace(std::istream& in, std::vector<GenerationTrace>& records) {
+    char magic[sizeof(trace_magic)];
+    uint64_t record_size = 0;
+    in.read(magic, sizeof(magic));
+    in.read((char*)&record_size, sizeof(record_size));
+    if (
+        !in ||
+        memcmp(magic, trace_magic, sizeof(magic)) != 0 ||
+        record_size != sizeof(GenerationTrace)
+    ) {
+        return false;
+    }
+
+    records.clear();
+    GenerationTrace record;
+    while (in.read((char*)&record, sizeof(record))) {
+        records.push_back(record);
+    }
+    return true;
+}
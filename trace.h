@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// One generation of `Problem::Genetic`. Every field is 8 bytes, so there is
+// no padding and binary traces hold the records as they are in memory.
+struct GenerationTrace {
+    uint64_t iter = 0;
+    uint64_t restarts = 0;
+    // Fitness as `EvalGenetic`, higher is better
+    int64_t best = 0;
+    int64_t worst = 0;
+    double mean = 0;
+    double diversity = 0;
+    double mutate_rate = 0;
+    // Wall time of the eval and reproduce phases, in seconds
+    double eval_time = 0;
+    double reproduce_time = 0;
+    // Time the worker threads were busy over the time they could have been,
+    // from 0 to 1
+    double utilisation = 0;
+    // Fraction of the population whose eval came from the memo
+    double cache_hit_ratio = 0;
+};
+
+enum class TraceFormat {
+    // One line per generation, with a header line
+    Csv,
+    // `trace_magic`, the record size as a uint64_t, then the records in the
+    // machine's byte order
+    Binary
+};
+
+const char trace_magic[8] = { 'G', 'A', 'T', 'R', 'A', 'C', 'E', '1' };
+
+// Per-generation trace of the genetic algorithm (see `Problem::trace`).
+// The solver only appends records to a batch; full batches are formatted
+// and written by a background thread, so tracing barely shifts the timings
+// it records. Records from one solver at a time.
+class GeneticTrace {
+private:
+    std::ostream& out;
+    TraceFormat format;
+    size_t batch_size;
+    std::vector<GenerationTrace> batch;
+
+    std::mutex mutex;
+    std::condition_variable ready_cv;
+    std::condition_variable written_cv;
+    std::vector<std::vector<GenerationTrace>> ready;
+    bool writing;
+    bool stopping;
+    size_t written;
+    std::thread writer;
+
+    void Hand();
+    void Write(const std::vector<GenerationTrace>& records);
+    void Run();
+
+public:
+    GeneticTrace(
+        std::ostream& out,
+        TraceFormat format = TraceFormat::Csv,
+        size_t batch_size = 256
+    );
+    GeneticTrace(const GeneticTrace&) = delete;
+    GeneticTrace& operator =(const GeneticTrace&) = delete;
+    ~GeneticTrace();
+
+    void Record(const GenerationTrace& record);
+
+    // Waits until every record so far is written, and flushes `out`
+    void Flush();
+
+    // Records written to `out` so far
+    size_t Written();
+};
+
+// Reads a binary trace. Returns false if it isn't one, or its records have
+// another size (e.g. from an older build).
+bool ReadBinaryTrace(std::istream& in, std::vector<GenerationTrace>& records);
@@ -0,0 +1,191 @@
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include "tts.h"
+#include "exact.h"
+#include "portfolio.h"
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    double Since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    TtsEngine GeneticEngine(
+        std::string name,
+        Problem::CrossoverType type,
+        const TtsOptions& options
+    ) {
+        TtsEngine engine;
+        engine.name = name;
+        engine.solve = [type, options] (Problem& problem) {
+            return problem.Genetic(
+                Checkpoint(),
+                options.population,
+                options.mutate_prob,
+                options.terminate_streak,
+                0,
+                type,
+                options.n_threads
+            );
+        };
+        return engine;
+    }
+}
+
+std::vector<TtsEngine> DefaultEngines(const TtsOptions& options) {
+    std::vector<TtsEngine> engines;
+
+    TtsEngine hill;
+    hill.name = "hill";
+    hill.solve = [] (Problem& problem) {
+        return problem.HillClimber(Checkpoint());
+    };
+    engines.push_back(hill);
+
+    engines.push_back(GeneticEngine(
+        "genetic_onepoint", Problem::CrossoverType::OnePoint, options
+    ));
+    engines.push_back(GeneticEngine(
+        "genetic_npoint", Problem::CrossoverType::NPoint, options
+    ));
+    engines.push_back(GeneticEngine(
+        "genetic_uniform", Problem::CrossoverType::Uniform, options
+    ));
+
+    TtsEngine exact;
+    exact.name = "exact";
+    exact.solve = [] (Problem& problem) {
+        return SolveExact(problem);
+    };
+    engines.push_back(exact);
+
+    TtsEngine portfolio;
+    portfolio.name = "portfolio";
+    portfolio.solve = [options] (Problem& problem) {
+        PortfolioOptions portfolio_options;
+        portfolio_options.population = options.population;
+        portfolio_options.mutate_prob = options.mutate_prob;
+        portfolio_options.terminate_streak = options.terminate_streak;
+        return Portfolio(portfolio_options).Solve(problem);
+    };
+    engines.push_back(portfolio);
+
+    return engines;
+}
+
+double Quantile(std::vector<double> values, double q) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    size_t rank = (size_t)std::ceil(q * values.size());
+    return values[std::min(std::max(rank, (size_t)1), values.size()) - 1];
+}
+
+TtsRun RunOnce(
+    const TtsEngine& engine,
+    Problem& problem,
+    uint32_t seed,
+    double budget
+) {
+    TtsRun run;
+    run.engine = engine.name;
+    run.seed = seed;
+
+    SeedRandom(seed);
+    Budget saved = problem.budget;
+    problem.budget = Budget::Within(budget);
+    auto start = Clock::now();
+    Checkpoint checkpoint = engine.solve(problem);
+    run.seconds = Since(start);
+    problem.budget = saved;
+    run.solved = checkpoint.is_goal && run.seconds <= budget;
+    run.evals = checkpoint.stats.evals + checkpoint.stats.cache_hits;
+    return run;
+}
+
+std::vector<TtsRun> MeasureTts(
+    const std::vector<TtsEngine>& engines,
+    Problem& problem,
+    const std::string& puzzle,
+    const TtsOptions& options
+) {
+    std::vector<TtsRun> runs;
+    for (auto& engine : engines) {
+        for (size_t k = 0; k < options.runs; ++k) {
+            TtsRun run = RunOnce(
+                engine, problem, options.seed + k, options.budget
+            );
+            run.puzzle = puzzle;
+            run.run = k;
+            runs.push_back(run);
+        }
+    }
+    return runs;
+}
+
+std::vector<TtsSummary> SummarizeTts(const std::vector<TtsRun>& runs) {
+    const double inf = std::numeric_limits<double>::infinity();
+
+    std::vector<TtsSummary> summaries;
+    std::vector<std::vector<double>> seconds;
+    std::vector<std::vector<double>> evals;
+    for (auto& run : runs) {
+        size_t i = 0;
+        while (
+            i < summaries.size() &&
+            (summaries[i].engine != run.engine ||
+                summaries[i].puzzle != run.puzzle)
+        ) {
+            i++;
+        }
+        if (i == summaries.size()) {
+            summaries.push_back(TtsSummary());
+            summaries[i].engine = run.engine;
+            summaries[i].puzzle = run.puzzle;
+            seconds.push_back(std::vector<double>());
+            evals.push_back(std::vector<double>());
+        }
+        summaries[i].runs++;
+        summaries[i].solved += run.solved;
+        seconds[i].push_back(run.solved ? run.seconds : inf);
+        evals[i].push_back(run.solved ? run.evals : inf);
+    }
+
+    for (size_t i = 0; i < summaries.size(); ++i) {
+        TtsSummary& summary = summaries[i];
+        summary.median = Quantile(seconds[i], 0.5);
+        summary.p90 = Quantile(seconds[i], 0.9);
+        summary.p99 = Quantile(seconds[i], 0.99);
+        summary.median_evals = Quantile(evals[i], 0.5);
+        summary.p90_evals = Quantile(evals[i], 0.9);
+    }
+    return summaries;
+}
+
+void WriteRunsCsv(const std::vector<TtsRun>& runs, std::ostream& out) {
+    out << "engine,puzzle,run,seed,solved,seconds,evals\n";
+    for (auto& run : runs) {
+        out <<
+            run.engine << "," << run.puzzle << "," << run.run << "," <<
+            run.seed << "," << run.solved << "," << run.seconds << "," <<
+            run.evals << "\n";
+    }
+}
+
+void WriteSummaryCsv(
+    const std::vector<TtsSummary>& summaries,
+    std::ostream& out
+) {
+    out <<
+        "engine,puzzle,runs,solved,success_rate,median_s,p90_s,p99_s," <<
+        "median_evals,p90_evals\n";
+    for (auto& s : summaries) {
+        out <<
+            s.engine << "," << s.puzzle << "," << s.runs << "," <<
+            s.solved << "," << s.SuccessRate() << "," << s.median << "," <<
+            s.p90 << "," << s.p99 << "," << s.median_evals << "," <<
+            s.p90_evals << "\n";
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+#include <cstdint>
+#include "lib.h"
+
+// Time-to-solution measurement for the stochastic solvers. Every engine runs
+// `runs` times per puzzle, run `k` seeded with `seed + k` (see `SeedRandom`),
+// so engines see the same seeds. Runs repeat exactly, except for the
+// portfolio, whose engines race, and genetic runs with more than one thread
+// and `GeneticOptions::hash_index`, whose threads share the index.
+
+struct TtsOptions {
+    size_t runs = 10;
+    // A run counts as solved only if it reaches the goal within this many
+    // seconds
+    double budget = 10;
+    uint32_t seed = 1;
+
+    // Genetic parameters, as for `TestHarnessGenetic`
+    size_t population = 200;
+    double mutate_prob = 0.1;
+    size_t terminate_streak = 200;
+    size_t n_threads = 1;
+};
+
+// A solver to measure. It runs with `problem.budget` set to a deadline
+// `TtsOptions::budget` seconds away, which the built-in solvers stop at.
+struct TtsEngine {
+    std::string name;
+    std::function<Checkpoint(Problem&)> solve;
+};
+
+// `hill`, `genetic_onepoint`, `genetic_npoint`, `genetic_uniform`, `exact`
+// and `portfolio`
+std::vector<TtsEngine> DefaultEngines(const TtsOptions& options);
+
+struct TtsRun {
+    std::string engine;
+    std::string puzzle;
+    size_t run = 0;
+    uint32_t seed = 0;
+    bool solved = false;
+    double seconds = 0;
+    // Evaluations and memo hits, from `SolverStats`
+    size_t evals = 0;
+};
+
+// Quantiles count unsolved runs as infinite, so e.g. `p90` is infinite
+// unless at least 90% of the runs were solved
+struct TtsSummary {
+    std::string engine;
+    std::string puzzle;
+    size_t runs = 0;
+    size_t solved = 0;
+    double median = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double median_evals = 0;
+    double p90_evals = 0;
+
+    inline double SuccessRate() const {
+        return runs ? (double)solved / runs : 0;
+    }
+};
+
+// Nearest-rank quantile, `q` in [0, 1]. 0 for no values.
+double Quantile(std::vector<double> values, double q);
+
+TtsRun RunOnce(
+    const TtsEngine& engine,
+    Problem& problem,
+    uint32_t seed,
+    double budget
+);
+
+// Runs every engine on the problem, `options.runs` times each
+std::vector<TtsRun> MeasureTts(
+    const std::vector<TtsEngine>& engines,
+    Problem& problem,
+    const std::string& puzzle,
+    const TtsOptions& options
+);
+
+// One summary per engine and puzzle, in order of first appearance
+std::vector<TtsSummary> SummarizeTts(const std::vector<TtsRun>& runs);
+
+void WriteRunsCsv(const std::vector<TtsRun>& runs, std::ostream& out);
+void WriteSummaryCsv(
+    const std::vector<TtsSummary>& summaries,
+    std::ostream& out
+);
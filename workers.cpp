@@ -0,0 +1,45 @@
+#include "workers.h"
+
+WorkerPool::WorkerPool(size_t n_threads) :
+    job(nullptr),
+    round(0),
+    running(0),
+    stopping(false) {
+    for (size_t t = 0; t < n_threads; ++t) {
+        threads.push_back(std::thread(&WorkerPool::Work, this, t));
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start_cv.notify_all();
+    for (auto& t : threads) t.join();
+}
+
+void WorkerPool::Run(const std::function<void(size_t)>& job) {
+    std::unique_lock<std::mutex> lock(mutex);
+    this->job = &job;
+    running = threads.size();
+    round++;
+    start_cv.notify_all();
+    done_cv.wait(lock, [this] () { return running == 0; });
+    this->job = nullptr;
+}
+
+void WorkerPool::Work(size_t worker) {
+    size_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        start_cv.wait(lock, [&] () { return round != seen || stopping; });
+        if (stopping) break;
+        seen = round;
+        const std::function<void(size_t)>& current = *job;
+        lock.unlock();
+        current(worker);
+        lock.lock();
+        if (--running == 0) done_cv.notify_one();
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Threads that run the same kind of job over and over, e.g. one phase of a
+// genetic generation, without starting new threads (and allocating their
+// state) each time. Jobs are passed by reference, so a `std::function` built
+// once can be run any number of times without allocating.
+class WorkerPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    const std::function<void(size_t)>* job;
+    // Bumped by every `Run`, so workers can tell a new job from the last one
+    size_t round;
+    size_t running;
+    bool stopping;
+
+    void Work(size_t worker);
+
+public:
+    WorkerPool(size_t n_threads);
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator =(const WorkerPool&) = delete;
+    ~WorkerPool();
+
+    // Calls `job(t)` on every thread `t` and waits for all of them
+    void Run(const std::function<void(size_t)>& job);
+
+    inline size_t Size() { return threads.size(); }
+};